@@ -8,32 +8,48 @@ copyright       MIT - Copyright (c) 2025 Oliver Blaser
 #include <string>
 
 #include "app.h"
+#include "middleware/acquisition.h"
+#include "middleware/adc-stream.h"
 #include "middleware/adc.h"
+#include "middleware/event-loop.h"
+#include "middleware/gesture.h"
 #include "middleware/gpio.h"
 #include "middleware/led-bar.h"
-#include "middleware/temperature.h"
+#include "middleware/pwm.h"
+#include "middleware/scheduler.h"
+#include "middleware/term.h"
 #include "project.h"
 
 #include <omw/clock.h>
 
-#include <rpihal/sys.h>
-
 
 #define LOG_MODULE_LEVEL LOG_LEVEL_INF
 #define LOG_MODULE_NAME  APP
 #include "middleware/log.h"
 
 
-using omw::clock::elapsed_ms;
 using omw::clock::timepoint_t;
 
 
+static constexpr timepoint_t updateInterval_us = 30 * 1000;
+static constexpr timepoint_t longPress_us = 1000 * 1000;
+static constexpr timepoint_t btn1DoubleClick_us = 250 * 1000;
+static constexpr timepoint_t btn1Hold_us = 600 * 1000;
+static constexpr timepoint_t btn1Repeat_us = 150 * 1000;
+static constexpr timepoint_t stateErrorInterval_us = 5 * omw::clock::second_us;
+static constexpr uint32_t breathePeriod_ms = 2000;
+
+// cells of the status line, the emulated LED bar starts at cell 20
+static constexpr int statusBarCol = 2;
+static constexpr int statusBarWidth = 16;
+
+
 enum
 {
     S_init = 0,
-    S_idle,
-    S_update,
+    S_run,
     S_exit,
+    S_error,
 };
 
 enum
@@ -55,11 +71,26 @@ static adc::Result potResult;
 static uint8_t btn1Cnt;
 static float tempCPU, tempPCB; // degC
 static bool showTemp_PCB_nCPU;
-static timepoint_t tpUpdate;
 
+static sched::Scheduler scheduler;
+static int taskUpdate = -1;
+static int taskGestures = -1;
 
+static gesture::Recognizer gestures;
+static int gestureBtn0 = -1;
+static int gestureBtn1 = -1;
+static int taskStateError = -1;
 
+
+
+static void updateTask(const timepoint_t& tpNow);
+static void gesturesTask(const timepoint_t& tpNow);
+static void stateErrorTask(const timepoint_t& tpNow);
 static void handleButtons(const timepoint_t& tpNow);
+static void processGestures(const timepoint_t& tpNow);
+static void handleGesture(const gesture::Event& event, const timepoint_t& tpNow);
+static void stepBtn1Cnt();
+static void setModeLeds();
 static void setLedBar();
 static void printStatusBar(int value, const char* unitStr);
 static void printStatusBar(float value, const char* unitStr);
@@ -79,8 +110,7 @@ void app::task()
     case S_init:
 
         mode = 0;
-        gpio::led0->clr();
-        gpio::led1->clr();
+        setModeLeds();
 
         potResult = 0;
         btn1Cnt = 0;
@@ -88,34 +118,37 @@ void app::task()
         tempPCB = 0;
         showTemp_PCB_nCPU = true;
 
-        tpUpdate = -omw::clock::second_us; // trigger update immediately
-
-        state = S_idle;
-
-        break;
+        taskUpdate = scheduler.add(updateTask, updateInterval_us);
+        taskGestures = scheduler.add(gesturesTask, 0);
+        taskStateError = scheduler.add(stateErrorTask, stateErrorInterval_us);
 
-    case S_idle:
-        if (elapsed_ms(tpNow, tpUpdate, 30))
         {
-            tpUpdate = tpNow;
-            state = S_update;
+            gesture::Timing timing = gesture::defaultTiming();
+            timing.doubleClick_us = 0; // the mode changes on release
+            timing.longPress_us = longPress_us;
+            gestureBtn0 = gestures.add(timing);
+
+            timing.doubleClick_us = btn1DoubleClick_us;
+            timing.longPress_us = btn1Hold_us;
+            timing.repeat_us = btn1Repeat_us;
+            gestureBtn1 = gestures.add(timing);
         }
-        break;
 
-    case S_update:
+        if ((gestureBtn0 < 0) || (gestureBtn1 < 0))
+        {
+            LOG_ERR("failed to add the gesture buttons");
+            state = S_error;
+            break;
+        }
 
-        potResult = adc::readPoti();
-        RPIHAL_SYS_getCpuTemp(&tempCPU);
-        tempPCB = temp::get();
+        scheduler.start(taskUpdate, tpNow);
 
-        setLedBar();
+        state = S_run;
 
-#ifdef RPIHAL_EMU
-        state = S_idle;
-#else
-        // state = S_idle;
-#endif
+        break;
 
+    case S_run:
+        scheduler.run(tpNow);
         break;
 
     case S_exit:
@@ -124,64 +157,149 @@ void app::task()
         break;
 
     default:
-        if (elapsed_ms(tpNow, tpUpdate, 5 * 1000))
+        if (!scheduler.active(taskStateError))
         {
-            tpUpdate = tpNow;
-            LOG_ERR("invalid state: %i", state);
+            scheduler.stop(taskUpdate);
+            scheduler.stop(taskGestures);
+            scheduler.start(taskStateError, tpNow);
         }
+        scheduler.run(tpNow);
         break;
     }
 }
 
+timepoint_t app::deadline()
+{
+    // init and exit are done in the next pass
+    if ((state == S_init) || (state == S_exit)) { return 0; }
+
+    return scheduler.deadline();
+}
+
 bool app::exit() { return exitSignal; }
 
 
 
-void handleButtons(const timepoint_t& tpNow)
+void updateTask(const timepoint_t& tpNow)
 {
-    static timepoint_t tpBtn0;
+    // latest values of the acquisition workers, never blocks on hardware
+    acq::Snapshot snapshot;
 
-    if (!gpio::btn0->state()) { tpBtn0 = tpNow; }
-    if (elapsed_ms(tpNow, tpBtn0, 1000))
+    if (adcStream::running())
     {
-        LOG_INF("BTN0 long press");
-        state = S_exit;
-    }
+        // the latest filtered sample, scaled back to 10 bit
+        adcStream::Sample sample;
+        adcStream::Sample ch0;
+        bool valid = false;
 
+        while (adcStream::pop(sample))
+        {
+            if (sample.channel == 0)
+            {
+                ch0 = sample;
+                valid = true;
+            }
+        }
 
+        if (valid) { potResult = adc::Result((uint16_t)(ch0.value / (float)(1u << (ch0.bits - 10)) + 0.5f)); }
+    }
+    else if (acq::get(acq::CH_poti, snapshot) && snapshot.valid) { potResult = adc::Result(snapshot.raw); }
+    if (acq::get(acq::CH_cpuTemp, snapshot) && snapshot.valid) { tempCPU = snapshot.value; }
+    if (acq::get(acq::CH_pcbTemp, snapshot) && snapshot.valid) { tempPCB = snapshot.value; }
 
-    if (gpio::btn0->pos()) { LOG_DBG("BTN0 pos"); }
-    if (gpio::btn0->neg())
-    {
-        LOG_DBG("BTN0 neg");
+    setLedBar();
+}
 
-        ++mode;
-        if (mode >= M__end_) { mode = 0; }
+void gesturesTask(const timepoint_t& tpNow)
+{
+    gestures.poll(tpNow);
+    processGestures(tpNow);
+}
 
-        static_assert(M__end_ == 4, "LED0,1 can't represent all modes");
-        gpio::led0->write((mode & 0x01) != 0);
-        gpio::led1->write((mode & 0x02) != 0);
+void stateErrorTask(const timepoint_t& tpNow) { LOG_ERR("invalid state: %i", state); }
 
-        tpUpdate = -omw::clock::second_us; // trigger update immediately
+void handleButtons(const timepoint_t& tpNow)
+{
+    // only the edges are processed here, the timers of the recognizer are run by the scheduler
+    if (gpio::btn0->pos() || gpio::btn0->neg()) { gestures.edge(gestureBtn0, gpio::btn0->state(), gpio::changeTime(gpio::btn0->pin())); }
+    if (gpio::btn1->pos() || gpio::btn1->neg()) { gestures.edge(gestureBtn1, gpio::btn1->state(), gpio::changeTime(gpio::btn1->pin())); }
 
-        LOG_INF("mode: %i %s", mode, modeString(mode).c_str());
-    }
+    processGestures(tpNow);
+}
+
+void processGestures(const timepoint_t& tpNow)
+{
+    gesture::Event event;
+    while (gestures.pop(event)) { handleGesture(event, tpNow); }
 
+    const timepoint_t tpGestures = gestures.deadline();
+    if (tpGestures != eventLoop::noDeadline) { scheduler.start(taskGestures, tpGestures); }
+    else { scheduler.stop(taskGestures); }
+}
 
+void handleGesture(const gesture::Event& event, const timepoint_t& tpNow)
+{
+    LOG_DBG("button %i gesture %i %u", event.button, event.type, event.count);
 
-    if (gpio::btn1->pos()) { LOG_DBG("BTN1 pos"); }
-    if (gpio::btn1->neg())
+    if (event.button == gestureBtn0)
     {
-        LOG_DBG("BTN1 neg");
+        if (event.type == gesture::E_click)
+        {
+            ++mode;
+            if (mode >= M__end_) { mode = 0; }
 
+            setModeLeds();
+
+            scheduler.start(taskUpdate, tpNow); // trigger update immediately
+
+            LOG_INF("mode: %i %s", mode, modeString(mode).c_str());
+        }
+        else if (event.type == gesture::E_longPress)
+        {
+            LOG_INF("BTN0 long press");
+            state = S_exit;
+        }
+    }
+    else if (event.button == gestureBtn1)
+    {
         if (mode == M_btn1)
         {
-            if (potResult.norm() >= 0.75f) { btn1Cnt += 0x10; }
-            else if (potResult.norm() >= 0.5f) { ++btn1Cnt; }
-            else if (potResult.norm() >= 0.25f) { --btn1Cnt; }
-            else { btn1Cnt -= 0x10; }
+            // hold to count continuously, double click to reset
+            if (event.type == gesture::E_doubleClick) { btn1Cnt = 0; }
+            else { stepBtn1Cnt(); }
+
+            scheduler.start(taskUpdate, tpNow);
+        }
+        else if ((mode == M_temp) && ((event.type == gesture::E_click) || (event.type == gesture::E_doubleClick)))
+        {
+            showTemp_PCB_nCPU = !showTemp_PCB_nCPU;
         }
-        else if (mode == M_temp) { showTemp_PCB_nCPU = !showTemp_PCB_nCPU; }
+    }
+}
+
+void stepBtn1Cnt()
+{
+    if (potResult.norm() >= 0.75f) { btn1Cnt += 0x10; }
+    else if (potResult.norm() >= 0.5f) { ++btn1Cnt; }
+    else if (potResult.norm() >= 0.25f) { --btn1Cnt; }
+    else { btn1Cnt -= 0x10; }
+}
+
+void setModeLeds()
+{
+    static_assert(M__end_ == 4, "LED0,1 can't represent all modes");
+
+    if (pwm::running())
+    {
+        // with software PWM the active LEDs breathe
+        pwm::setBreathing(gpio::Led0::number, breathePeriod_ms, ((mode & 0x01) ? pwm::resolution() : 0));
+        pwm::setBreathing(gpio::Led1::number, breathePeriod_ms, ((mode & 0x02) ? pwm::resolution() : 0));
+    }
+    else
+    {
+        gpio::led0->stage((mode & 0x01) != 0);
+        gpio::led1->stage((mode & 0x02) != 0);
+        gpio::outputs().commit(); // both LEDs switch at once
     }
 }
 
@@ -227,23 +345,9 @@ void setLedBar()
     }
 }
 
-void printStatusBar(int value, const char* unitStr)
-{
-    const char* const format = "\033[2C" // cursor forward
-                               "%i%s   " // value
-                               "\r";     // cursor return
-
-    printf(format, value, unitStr);
-}
+void printStatusBar(int value, const char* unitStr) { term::putf(statusBarCol, statusBarWidth, "%i%s", value, unitStr); }
 
-void printStatusBar(float value, const char* unitStr)
-{
-    const char* const format = "\033[2C"   // cursor forward
-                               "%.2f%s   " // value
-                               "\r";       // cursor return
-
-    printf(format, (double)value, unitStr);
-}
+void printStatusBar(float value, const char* unitStr) { term::putf(statusBarCol, statusBarWidth, "%.2f%s", (double)value, unitStr); }
 
 std::string modeString(int mode)
 {
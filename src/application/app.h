@@ -9,11 +9,20 @@ copyright       MIT - Copyright (c) 2025 Oliver Blaser
 #include <cstddef>
 #include <cstdint>
 
+#include <omw/clock.h>
+
 
 namespace app {
 
 void task();
 
+/**
+ * @brief Returns the point in time at which `app::task()` has to be called at the latest.
+ *
+ * Inputs are handled by the event loop, the deadline is the next deadline of the application's scheduler.
+ */
+omw::clock::timepoint_t deadline();
+
 bool exit();
 
 }
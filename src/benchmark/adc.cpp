@@ -0,0 +1,97 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "benchmark.h"
+#include "middleware/adc.h"
+#include "middleware/histogram.h"
+#include "middleware/util.h"
+
+
+namespace {
+
+struct Strategy
+{
+    int cs;
+    const char* name;
+};
+
+}
+
+// the GPIO strategy is last, the kernel strategies need GPIO 8 as CE0
+static const Strategy strategies[] = {
+    { adc::CS_kernel, "CS_kernel" },
+    { adc::CS_batched, "CS_batched" },
+    { adc::CS_gpio, "CS_gpio" },
+};
+
+static constexpr size_t iterations = 2000;
+
+static util::Histogram hist;
+
+static void printStats(const std::string& name, uint64_t conversions, uint64_t dt_ns, uint64_t div);
+
+
+
+void benchmark::adc()
+{
+    for (size_t i = 0; i < SIZEOF_ARRAY(strategies); ++i)
+    {
+        const Strategy& s = strategies[i];
+
+        if (::adc::init(s.cs))
+        {
+            std::printf("  %s adc::init() failed\n", s.name);
+            continue;
+        }
+
+        uint64_t t0, t1;
+        ::adc::Result result;
+
+        // single conversions, the duration of a call is about the time nCS is asserted plus the syscall
+        hist.reset();
+        t0 = util::monotonic_ns();
+        for (size_t k = 0; k < iterations; ++k)
+        {
+            const uint64_t t = util::monotonic_ns();
+            ::adc::read(0, result);
+            keep(result);
+            hist.record(util::monotonic_ns() - t);
+        }
+        t1 = util::monotonic_ns();
+        printStats(std::string(s.name) + " read()", iterations, t1 - t0, 1);
+
+        // all channels, per conversion
+        ::adc::Result results[::adc::channelCount];
+        hist.reset();
+        t0 = util::monotonic_ns();
+        for (size_t k = 0; k < iterations; ++k)
+        {
+            const uint64_t t = util::monotonic_ns();
+            ::adc::scan(0x0F, results);
+            hist.record(util::monotonic_ns() - t);
+            keep(results);
+        }
+        t1 = util::monotonic_ns();
+        printStats(std::string(s.name) + " scan() 4 ch", iterations * ::adc::channelCount, t1 - t0, ::adc::channelCount);
+
+        ::adc::deinit();
+    }
+}
+
+
+
+void printStats(const std::string& name, uint64_t conversions, uint64_t dt_ns, uint64_t div)
+{
+    using namespace benchmark;
+
+    printRate((name + ", conversions").c_str(), (double)conversions * 1e9 / (double)dt_ns);
+    printResult((name + ", median per conversion").c_str(), (double)hist.percentile(50) / (double)div);
+    printResult((name + ", jitter (p99 - p1) per call").c_str(), (double)(hist.percentile(99) - hist.percentile(1)));
+}
@@ -0,0 +1,74 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "benchmark.h"
+
+
+#define LOG_MODULE_LEVEL LOG_LEVEL_INF
+#define LOG_MODULE_NAME  BENCH
+#include "middleware/log.h"
+
+
+namespace {
+
+struct Case
+{
+    const char* name;
+    void (*func)();
+    bool hardware; // accesses the test hardware, only run if explicitly selected
+};
+
+}
+
+static const Case cases[] = {
+    { "adc", benchmark::adc, true },
+    { "convert", benchmark::convert, false },
+    { "gpio", benchmark::gpio, false },
+    { "pulse", benchmark::pulse, false },
+    { "pulse-loopback", benchmark::pulseLoopback, true },
+    { "timestamp", benchmark::timestamp, false },
+};
+
+const void* volatile benchmark::___sink = nullptr;
+
+
+
+int benchmark::run(const std::string& filter)
+{
+    int cnt = 0;
+
+    for (size_t i = 0; i < SIZEOF_ARRAY(cases); ++i)
+    {
+        const Case& c = cases[i];
+
+        if (c.hardware && filter.empty()) { continue; }
+
+        if (std::string(c.name).compare(0, filter.length(), filter) == 0)
+        {
+            printTitle(c.name);
+            c.func();
+            ++cnt;
+        }
+    }
+
+    if (cnt == 0)
+    {
+        LOG_ERR("no benchmark matches \"%s\"", filter.c_str());
+        return -(__LINE__);
+    }
+
+    return 0;
+}
+
+void benchmark::printTitle(const char* name) { std::printf("\n\033[1m%s\033[0m\n", name); }
+
+void benchmark::printResult(const char* name, double ns) { std::printf("  %-56s %10.1f ns\n", name, ns); }
+
+void benchmark::printRate(const char* name, double perSecond) { std::printf("  %-56s %10.0f /s\n", name, perSecond); }
@@ -0,0 +1,79 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_BENCHMARK_BENCHMARK_H
+#define IG_BENCHMARK_BENCHMARK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "middleware/util.h"
+
+
+namespace benchmark {
+
+/**
+ * @brief Runs the benchmarks and prints the results.
+ *
+ * @param filter Only the benchmarks whose name starts with `filter` are run, all if empty
+ * @return 0 on success
+ */
+int run(const std::string& filter);
+
+
+
+// benchmark cases
+
+void adc(); // needs the test hardware
+void convert();
+void gpio(); // only in the emulator build
+void pulse();
+void pulseLoopback(); // needs the test hardware, LED0 wired to BTN0
+void timestamp();
+
+
+
+// helpers for the benchmark cases
+
+extern const void* volatile ___sink;
+
+/**
+ * @brief Prevents the compiler from optimising away the computation of the value.
+ */
+template <typename T> inline void keep(const T& value) { ___sink = &value; }
+
+/**
+ * @brief Measures the average duration of `func()`.
+ *
+ * @param iterations Number of calls per round
+ * @param rounds The fastest round is taken, to filter out interrupts and scheduling
+ * @return ns per call
+ */
+template <typename F> double measure(F&& func, size_t iterations = 100000, size_t rounds = 5)
+{
+    double best = 0;
+
+    for (size_t r = 0; r < rounds; ++r)
+    {
+        const uint64_t t0 = util::monotonic_ns();
+        for (size_t i = 0; i < iterations; ++i) { func(); }
+        const uint64_t t1 = util::monotonic_ns();
+
+        const double t = (double)(t1 - t0) / (double)iterations;
+        if ((r == 0) || (t < best)) { best = t; }
+    }
+
+    return best;
+}
+
+void printTitle(const char* name);
+void printResult(const char* name, double ns);
+void printRate(const char* name, double perSecond);
+
+} // namespace benchmark
+
+
+#endif // IG_BENCHMARK_BENCHMARK_H
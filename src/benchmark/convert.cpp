@@ -0,0 +1,114 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "benchmark.h"
+#include "middleware/adc-convert.h"
+#include "middleware/adc.h"
+
+
+namespace {
+
+// the result class before it was made trivially copyable
+class LegacyResult
+{
+public:
+    LegacyResult()
+        : m_value(0), m_norm(0)
+    {}
+
+    LegacyResult(uint16_t value)
+        : m_value(value), m_norm((float)value / 1023.0f)
+    {}
+
+    virtual ~LegacyResult() {}
+
+    uint16_t value() const { return m_value; }
+    float norm() const { return m_norm; }
+
+private:
+    uint16_t m_value;
+    float m_norm;
+};
+
+}
+
+static constexpr size_t bufferSize = 4096;
+
+static uint16_t raw[bufferSize];
+static LegacyResult legacyResults[bufferSize];
+static adc::Result results[bufferSize];
+static float values[bufferSize];
+static uint16_t valuesQ15[bufferSize];
+
+
+
+void benchmark::convert()
+{
+    double t;
+
+    for (size_t i = 0; i < bufferSize; ++i) { raw[i] = (uint16_t)((i * 7) % (adc::maxValue + 1)); }
+
+    std::printf("  %-56s %4zu / %zu bytes\n", "sizeof LegacyResult / adc::Result", sizeof(LegacyResult), sizeof(adc::Result));
+
+    t = measure(
+        [&]
+        {
+            for (size_t i = 0; i < bufferSize; ++i) { legacyResults[i] = LegacyResult(raw[i]); }
+            for (size_t i = 0; i < bufferSize; ++i) { values[i] = legacyResults[i].norm(); }
+            keep(values);
+        },
+        200);
+    printResult("LegacyResult store and norm(), per sample", t / (double)bufferSize);
+
+    t = measure(
+        [&]
+        {
+            for (size_t i = 0; i < bufferSize; ++i) { results[i] = adc::Result(raw[i]); }
+            for (size_t i = 0; i < bufferSize; ++i) { values[i] = results[i].norm(); }
+            keep(values);
+        },
+        200);
+    printResult("adc::Result store and norm(), per sample", t / (double)bufferSize);
+
+    t = measure(
+        [&]
+        {
+            adc::normalise(raw, values, bufferSize);
+            keep(values);
+        },
+        2000);
+    printResult("adc::normalise(), per sample", t / (double)bufferSize);
+
+    t = measure(
+        [&]
+        {
+            adc::normaliseQ15(raw, valuesQ15, bufferSize);
+            keep(valuesQ15);
+        },
+        2000);
+    printResult("adc::normaliseQ15(), per sample", t / (double)bufferSize);
+
+    t = measure(
+        [&]
+        {
+            adc::scale(raw, values, bufferSize, 3.3f / 1023.0f);
+            keep(values);
+        },
+        2000);
+    printResult("adc::scale(), per sample", t / (double)bufferSize);
+
+    t = measure(
+        [&]
+        {
+            adc::decimate(raw, valuesQ15, bufferSize, 16);
+            keep(valuesQ15);
+        },
+        2000);
+    printResult("adc::decimate() by 16, per input sample", t / (double)bufferSize);
+}
@@ -0,0 +1,166 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "benchmark.h"
+#include "gpio-pins.h"
+#include "middleware/gpio.h"
+
+#include <rpihal/gpio.h>
+
+
+namespace {
+
+// the input classes before the input bank
+class LegacyInput
+{
+public:
+    explicit LegacyInput(int pin)
+        : m_pin(pin)
+    {}
+
+    virtual ~LegacyInput() {}
+
+    virtual bool read(uint64_t levels) const = 0;
+
+protected:
+    int m_pin;
+};
+
+class LegacyInputActiveLow : public LegacyInput
+{
+public:
+    explicit LegacyInputActiveLow(int pin)
+        : LegacyInput(pin)
+    {}
+
+    virtual ~LegacyInputActiveLow() {}
+
+    virtual bool read(uint64_t levels) const { return ((levels & RPIHAL_GPIO_BIT(m_pin)) == 0); }
+};
+
+}
+
+
+
+void benchmark::gpio()
+{
+#ifdef RPIHAL_EMU
+
+    if (RPIHAL_GPIO_init())
+    {
+        std::printf("  RPIHAL_GPIO_init() failed\n");
+        return;
+    }
+
+    RPIHAL_GPIO_init_t initStruct;
+    RPIHAL_GPIO_defaultInitStruct(&initStruct);
+    initStruct.mode = RPIHAL_GPIO_MODE_OUT;
+    RPIHAL_GPIO_initPin(GPIO_LED0, &initStruct);
+    RPIHAL_GPIO_initPin(GPIO_LED1, &initStruct);
+
+    double t;
+    bool state = false;
+    uint64_t levels = 0;
+
+    gpio::OutputActiveHigh runtimeOutput(GPIO_LED0);
+    gpio::OutputAdapter<gpio::Led0> adapterOutput;
+    const LegacyInputActiveLow legacyInput(GPIO_BTN0);
+
+    // read through volatile pointers, so the calls can't be devirtualised
+    gpio::Output* volatile const runtimeOutputPtr = &runtimeOutput;
+    gpio::Output* volatile const adapterOutputPtr = &adapterOutput;
+    const LegacyInput* volatile const legacyInputPtr = &legacyInput;
+
+    t = measure(
+        [&]
+        {
+            state = !state;
+            runtimeOutputPtr->write(state);
+        });
+    printResult("virtual Output::write(), runtime pin", t);
+
+    t = measure(
+        [&]
+        {
+            state = !state;
+            adapterOutputPtr->write(state);
+        });
+    printResult("type erased OutputAdapter<OutputPin>::write()", t);
+
+    t = measure(
+        [&]
+        {
+            state = !state;
+            gpio::Led0::write(state);
+        });
+    printResult("OutputPin::write()", t);
+
+    t = measure(
+        [&]
+        {
+            state = !state;
+            gpio::Led0::write(state);
+            gpio::Led1::write(state);
+        });
+    printResult("2 pins, OutputPin::write() each", t);
+
+    gpio::OutputGroup group;
+    group.add<gpio::Led0>();
+    group.add<gpio::Led1>();
+    group.sync();
+
+    t = measure(
+        [&]
+        {
+            state = !state;
+            group.write(group.pins(), (state ? UINT64_MAX : 0));
+            group.commit();
+        });
+    printResult("2 pins, OutputGroup::commit()", t);
+
+    t = measure(
+        [&]
+        {
+            ++levels;
+            keep(legacyInputPtr->read(levels));
+        },
+        1000000);
+    printResult("virtual read(levels), runtime pin", t);
+
+    t = measure(
+        [&]
+        {
+            ++levels;
+            keep(gpio::InputPin<GPIO_BTN0, gpio::PP_activeLow>::read(levels));
+        },
+        1000000);
+    printResult("InputPin::read(levels)", t);
+
+    gpio::Encoder encoder(GPIO_BTN0, GPIO_BTN1);
+    uint64_t t_ns = 0;
+    encoder.reset(0, t_ns);
+
+    t = measure(
+        [&]
+        {
+            // gray code sequence, one step per call
+            ++levels;
+            t_ns += 1000;
+            encoder.update(((levels ^ (levels >> 1)) & 3) << GPIO_BTN0, t_ns);
+        },
+        1000000);
+    printResult("Encoder::update()", t);
+
+    RPIHAL_GPIO_resetPin(GPIO_LED0);
+    RPIHAL_GPIO_resetPin(GPIO_LED1);
+
+#else  // RPIHAL_EMU
+    std::printf("  only available in the emulator build\n");
+#endif // RPIHAL_EMU
+}
@@ -0,0 +1,224 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "benchmark.h"
+#include "gpio-pins.h"
+#include "middleware/pulse.h"
+#include "middleware/util.h"
+
+#include <rpihal/gpio.h>
+
+
+// signal frequencies of the loopback sweep
+static const uint32_t loopbackFrequencies_Hz[] = { 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000 };
+static constexpr uint32_t loopbackBurst_ms = 200;
+static constexpr uint32_t loopbackWindow_ms = 50;
+
+static bool loopbackBurst(uint32_t frequency_Hz, uint64_t& edges, double& rate_Hz, ::pulse::Snapshot& delta);
+
+
+
+void benchmark::pulse()
+{
+    double t;
+    uint64_t t_ns = 0;
+
+    ::pulse::Counter counter;
+    ::pulse::Snapshot snapshot;
+
+    t = measure(
+        [&]
+        {
+            t_ns += 10000;
+            counter.edge(t_ns);
+        },
+        1000000);
+    printResult("Counter::edge()", t);
+
+    // a batch as it is read from the line fd, decoded by the same function as in the counter thread
+    constexpr size_t batchSize = 64;
+    ::pulse::LineEvent batch[batchSize] = {};
+    ::pulse::Counter counters[64];
+    uint32_t lastSeqno[64] = {};
+    uint32_t lost[64] = {};
+    uint32_t seqno[64] = {};
+
+    t = measure(
+        [&]
+        {
+            for (size_t i = 0; i < batchSize; ++i)
+            {
+                t_ns += 10000;
+                batch[i].timestamp_ns = t_ns;
+                batch[i].offset = (uint32_t)(17 + (i & 1));
+                batch[i].line_seqno = ++seqno[batch[i].offset];
+            }
+
+            ::pulse::decode(batch, batchSize, counters, lastSeqno, lost);
+
+            keep(lost);
+        },
+        20000);
+    const double tEvent = t / (double)batchSize;
+    printResult("decode and count, per edge (batches of 64)", tEvent);
+
+    t = measure(
+        [&]
+        {
+            t_ns += 1000000000;
+            counter.edge(t_ns);
+            counter.window(t_ns, 1, snapshot);
+            keep(snapshot);
+        });
+    printResult("Counter::window()", t);
+
+    // the sampling fallback misses edges if a wakeup is late by more than half a signal period
+    constexpr size_t nSamples = 4000;
+    const uint64_t period_ns = (uint64_t)::pulse::samplePeriod_us * 1000;
+    uint64_t maxLate_ns = 0;
+    uint64_t next = util::monotonic_ns();
+
+    for (size_t i = 0; i < nSamples; ++i)
+    {
+        next += period_ns;
+        util::sleep_until(next);
+
+        const uint64_t now = util::monotonic_ns();
+        if ((now > next) && ((now - next) > maxLate_ns)) { maxLate_ns = now - next; }
+    }
+
+    printResult("sampling fallback, max wakeup latency", (double)maxLate_ns);
+
+    std::printf("  max edge rate of the counter thread, estimate (user space) %8.1f MHz\n", 1e3 / tEvent);
+    std::printf("  max signal frequency with the sampling fallback, estimate  %8.2f kHz\n", 1e6 / (double)(2 * (period_ns + maxLate_ns)));
+    std::printf("  with the GPIO character device the limit is the kernel interrupt handling, it is measured by the\n");
+    std::printf("  `pulse-loopback` benchmark (needs LED0 wired to BTN0)\n");
+}
+
+void benchmark::pulseLoopback()
+{
+    if (RPIHAL_GPIO_init())
+    {
+        std::printf("  RPIHAL_GPIO_init() failed\n");
+        return;
+    }
+
+    RPIHAL_GPIO_init_t initStruct;
+    RPIHAL_GPIO_defaultInitStruct(&initStruct);
+
+    initStruct.mode = RPIHAL_GPIO_MODE_IN;
+    initStruct.pull = RPIHAL_GPIO_PULL_NONE;
+    const int errIn = RPIHAL_GPIO_initPin(GPIO_BTN0, &initStruct);
+
+    initStruct.mode = RPIHAL_GPIO_MODE_OUT;
+    const int errOut = RPIHAL_GPIO_initPin(GPIO_LED0, &initStruct);
+
+    if (errIn || errOut)
+    {
+        std::printf("  RPIHAL_GPIO_initPin() failed\n");
+        return;
+    }
+
+    RPIHAL_GPIO_clr(RPIHAL_GPIO_BIT(GPIO_LED0));
+
+    ::pulse::Config cfg = ::pulse::defaultConfig();
+    cfg.pins = RPIHAL_GPIO_BIT(GPIO_BTN0);
+    cfg.window_ms = loopbackWindow_ms;
+    cfg.edges = ::pulse::E_both;
+
+    if (::pulse::start(cfg))
+    {
+        std::printf("  pulse::start() failed\n");
+        return;
+    }
+
+    // the frequency is raised until an edge is missed or lost
+    double maxRate_Hz = 0;
+
+    for (size_t i = 0; i < SIZEOF_ARRAY(loopbackFrequencies_Hz); ++i)
+    {
+        uint64_t edges;
+        double rate_Hz;
+        ::pulse::Snapshot delta;
+
+        const bool ok = loopbackBurst(loopbackFrequencies_Hz[i], edges, rate_Hz, delta);
+
+        char label[80];
+        std::snprintf(label, sizeof(label), "%6.1fkHz burst, %llu of %llu edges counted, %u lost", (double)loopbackFrequencies_Hz[i] / 1000.0,
+                      (unsigned long long)delta.count, (unsigned long long)edges, delta.lost);
+        std::printf("  %-56s %10.0f Hz %s\n", label, rate_Hz, (ok ? "ok" : "FAIL"));
+
+        if (!ok) { break; }
+        maxRate_Hz = rate_Hz;
+    }
+
+    ::pulse::stop();
+
+    RPIHAL_GPIO_clr(RPIHAL_GPIO_BIT(GPIO_LED0));
+    RPIHAL_GPIO_resetPin(GPIO_LED0);
+    RPIHAL_GPIO_resetPin(GPIO_BTN0);
+
+    // the rate is the one actually generated, the generator may be slower than the requested frequency
+    std::printf("  %-56s %10.0f Hz\n", "highest signal frequency counted without loss", maxRate_Hz);
+}
+
+
+
+/**
+ * @brief Generates a burst of `loopbackBurst_ms` on LED0 and compares it with the count of BTN0.
+ *
+ * @param edges Generated edges
+ * @param rate_Hz Generated signal frequency
+ * @param delta Edges counted and lost during the burst
+ * @return `true` if all edges were counted and none was lost
+ */
+bool loopbackBurst(uint32_t frequency_Hz, uint64_t& edges, double& rate_Hz, ::pulse::Snapshot& delta)
+{
+    const uint64_t led = RPIHAL_GPIO_BIT(GPIO_LED0);
+    const uint64_t halfPeriod_ns = 500000000ull / frequency_Hz;
+
+    edges = 2 * ((uint64_t)frequency_Hz * loopbackBurst_ms / 1000);
+
+    // the snapshots are published once per window, one is always complete after two
+    ::pulse::Snapshot before, after;
+    util::sleep(2 * loopbackWindow_ms);
+    if (!::pulse::get(GPIO_BTN0, before))
+    {
+        before.count = 0;
+        before.lost = 0;
+    }
+
+    // busy waiting, a sleep per edge would limit the frequency to the timer slack
+    const uint64_t t0 = util::monotonic_ns();
+    uint64_t next = t0;
+
+    for (uint64_t k = 0; k < edges; ++k)
+    {
+        next += halfPeriod_ns;
+        while (util::monotonic_ns() < next) {}
+
+        if (k & 1) { RPIHAL_GPIO_clr(led); }
+        else { RPIHAL_GPIO_set(led); }
+    }
+
+    const uint64_t t1 = util::monotonic_ns();
+
+    util::sleep(2 * loopbackWindow_ms);
+    if (!::pulse::get(GPIO_BTN0, after))
+    {
+        after.count = 0;
+        after.lost = 0;
+    }
+
+    rate_Hz = (double)edges * 0.5e9 / (double)(t1 - t0);
+    delta.count = after.count - before.count;
+    delta.lost = after.lost - before.lost;
+
+    return ((delta.count == edges) && (delta.lost == 0));
+}
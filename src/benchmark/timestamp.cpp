@@ -0,0 +1,71 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+#include "benchmark.h"
+#include "middleware/timestamp.h"
+#include "middleware/util.h"
+
+
+// the implementation of `util::t_to_iso8601_local()` before the cached formatter
+static std::string legacy_t_to_iso8601_local(time_t t)
+{
+    std::string r;
+
+    constexpr size_t bufferSize = 100;
+    char buffer[bufferSize];
+
+    const struct std::tm* tm = std::localtime(&t);
+
+    if (tm && (std::strftime(buffer, bufferSize, "%FT%T", tm) > 0)) { r = std::string(buffer); }
+    else { r = '[' + std::to_string(t) + ']'; }
+
+    return r;
+}
+
+
+
+void benchmark::timestamp()
+{
+    double t;
+    char buffer[40];
+
+    t = measure([] { keep(legacy_t_to_iso8601_local(std::time(nullptr))); });
+    printResult("before: localtime() strftime() std::string", t);
+
+    t = measure([] { keep(util::t_to_iso8601_local(std::time(nullptr))); });
+    printResult("util::t_to_iso8601_local() (cached, std::string)", t);
+
+    t = measure(
+        [&buffer]
+        {
+            util::format_timestamp(buffer, sizeof(buffer), util::TSF_iso8601_local, util::TSR_s, (int64_t)std::time(nullptr) * 1000000000);
+            keep(buffer);
+        });
+    printResult("util::format_timestamp() s", t);
+
+    t = measure(
+        [&buffer]
+        {
+            util::format_timestamp(buffer, sizeof(buffer), util::TSF_iso8601_local, util::TSR_ms, util::monotonic_to_wall_ns(util::monotonic_ns()));
+            keep(buffer);
+        });
+    printResult("util::format_timestamp() ms, monotonic anchored", t);
+
+    t = measure(
+        [&buffer]
+        {
+            util::format_timestamp(buffer, sizeof(buffer), util::TSF_iso8601, util::TSR_us, util::monotonic_to_wall_ns(util::monotonic_ns()));
+            keep(buffer);
+        });
+    printResult("util::format_timestamp() us with UTC offset", t);
+
+    t = measure([] { keep(util::monotonic_ns()); });
+    printResult("util::monotonic_ns() (reference)", t);
+}
@@ -3,14 +3,26 @@ author          Oliver Blaser
 copyright       MIT - Copyright (c) 2024 Oliver Blaser
 */
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 
 #include "application/app.h"
+#include "benchmark/benchmark.h"
+#include "middleware/acquisition.h"
+#include "middleware/adc-scope.h"
+#include "middleware/adc-stream.h"
 #include "middleware/adc.h"
+#include "middleware/event-loop.h"
 #include "middleware/gpio.h"
+#include "middleware/input-sampler.h"
 #include "middleware/led-bar.h"
+#include "middleware/perf.h"
+#include "middleware/pulse.h"
+#include "middleware/pwm.h"
 #include "middleware/temperature.h"
+#include "middleware/term.h"
 #include "middleware/util.h"
 #include "project.h"
 #include "system-test/cli.h"
@@ -34,12 +46,18 @@ copyright       MIT - Copyright (c) 2024 Oliver Blaser
 #include "middleware/log.h"
 
 
-#define ARG_FLAG_TEST (0x00000001)
-#define ARG_FLAG_GPIO (0x00000002)
-#define ARG_FLAG_SPI  (0x00000004)
-#define ARG_FLAG_I2C  (0x00000008)
-#define ARG_FLAG_ALL  (ARG_FLAG_GPIO | ARG_FLAG_SPI | ARG_FLAG_I2C)
-#define ARG_FLAG_APP  (0x00000010)
+#define ARG_FLAG_TEST      (0x00000001)
+#define ARG_FLAG_GPIO      (0x00000002)
+#define ARG_FLAG_SPI       (0x00000004)
+#define ARG_FLAG_I2C       (0x00000008)
+#define ARG_FLAG_ALL       (ARG_FLAG_GPIO | ARG_FLAG_SPI | ARG_FLAG_I2C)
+#define ARG_FLAG_APP       (0x00000010)
+#define ARG_FLAG_RT        (0x00000020)
+#define ARG_FLAG_BENCH     (0x00000040)
+#define ARG_FLAG_PULSE     (0x00000080)
+#define ARG_FLAG_PWM       (0x00000100)
+#define ARG_FLAG_ADCSTREAM (0x00000200)
+#define ARG_FLAG_SCOPE     (0x00000400)
 
 
 namespace {
@@ -65,6 +83,22 @@ static_assert(EC__end_ <= EC__max_, "too many error codes defined");
 
 
 
+static constexpr size_t binlogSize = 64 * 1024 * 1024;
+
+static int rtCpu = -1;
+static int adcCs = adc::CS_batched;
+static uint32_t pulseWindow_ms = 1000;
+static uint32_t pwmFrequency_Hz = 0; // 0 for the default
+static uint32_t pwmResolution = 0;
+static uint32_t adcStreamRate_Hz = 0; // 0 for the default
+static int adcStreamBits = -1;        // negative for the default
+static int scopeLevel = -1;           // negative to trigger on BTN1
+static std::string benchFilter;
+static std::string binlogFile;
+static std::string scopeFile;
+
+
+
 static uint32_t parseArgs(int argc, char** argv);
 
 
@@ -160,14 +194,95 @@ int main(int argc, char** argv)
 
     // system test cases
     //==================================================================================================================
+    // benchmarks
+
+    if ((r == EC_OK) && (argFlags & ARG_FLAG_BENCH))
+    {
+        if (benchmark::run(benchFilter)) { r = EC_ERROR; }
+    }
+
+    // benchmarks
+    //==================================================================================================================
     // demo application
 
     if ((r == EC_OK) && (argFlags & ARG_FLAG_APP))
     {
-        if (adc::init()) { r = EC_RPIHAL_INIT_ERROR; }
+        // the control loop must not block on terminal I/O, the system test output stays synchronous
+        if (!binlogFile.empty())
+        {
+            if (logging::startBinary(binlogFile.c_str(), binlogSize)) { r = EC_ERROR; }
+        }
+        else if (logging::start(logging::FP_drop)) { r = EC_RPIHAL_INIT_ERROR; }
+
+        if (eventLoop::init()) { r = EC_RPIHAL_INIT_ERROR; }
+        if (adc::init(adcCs)) { r = EC_RPIHAL_INIT_ERROR; }
         if (gpio::init()) { r = EC_RPIHAL_INIT_ERROR; }
         if (ledBar::init()) { r = EC_RPIHAL_INIT_ERROR; }
         if (temp::init()) { r = EC_RPIHAL_INIT_ERROR; }
+        if (perf::init()) { r = EC_RPIHAL_INIT_ERROR; }
+        if (term::init(30)) { r = EC_RPIHAL_INIT_ERROR; }
+
+        if ((r == EC_OK) && (argFlags & ARG_FLAG_PULSE))
+        {
+            pulse::Config cfg = pulse::defaultConfig();
+            cfg.pins = RPIHAL_GPIO_BIT(GPIO_BTN1); // BTN0 stays an input, its long press exits the application
+            cfg.window_ms = pulseWindow_ms;
+
+            if (gpio::startPulseCounting(cfg)) { r = EC_RPIHAL_INIT_ERROR; }
+        }
+
+        if ((r == EC_OK) && (argFlags & ARG_FLAG_PWM))
+        {
+            pwm::Config cfg = pwm::defaultConfig();
+            cfg.pins = RPIHAL_GPIO_BIT(GPIO_LED0) | RPIHAL_GPIO_BIT(GPIO_LED1);
+            if (pwmFrequency_Hz > 0) { cfg.frequency_Hz = pwmFrequency_Hz; }
+            if (pwmResolution > 0) { cfg.resolution = pwmResolution; }
+
+            if (gpio::startPwm(cfg)) { r = EC_RPIHAL_INIT_ERROR; }
+        }
+
+        if ((r == EC_OK) && (argFlags & ARG_FLAG_ADCSTREAM))
+        {
+            adcStream::Config cfg = adcStream::defaultConfig();
+            cfg.channels = 0x01; // poti
+            if (adcStreamRate_Hz > 0) { cfg.rate_Hz = adcStreamRate_Hz; }
+            if (adcStreamBits >= 0) { cfg.oversampleBits = (unsigned)adcStreamBits; }
+
+            if (adcStream::start(cfg)) { r = EC_RPIHAL_INIT_ERROR; }
+        }
+
+        if ((r == EC_OK) && (argFlags & ARG_FLAG_SCOPE))
+        {
+            adcScope::Config cfg = adcScope::defaultConfig();
+            cfg.channel = 0; // poti
+            cfg.file = scopeFile.c_str();
+
+            if (scopeLevel >= 0)
+            {
+                cfg.level = (uint16_t)scopeLevel;
+                cfg.edges = adcScope::E_both;
+            }
+            else { cfg.pin = GPIO_BTN1; }
+
+            if (adcScope::start(cfg)) { r = EC_RPIHAL_INIT_ERROR; }
+        }
+
+        if ((r == EC_OK) && (argFlags & ARG_FLAG_RT))
+        {
+            inputSampler::Config cfg = inputSampler::defaultConfig();
+            cfg.cpu = rtCpu;
+
+            if (gpio::startRtSampling(cfg)) { r = EC_RPIHAL_INIT_ERROR; }
+        }
+
+        if (r == EC_OK)
+        {
+            // the stream owns the poti channel, polling it in addition would only load the SPI bus
+            uint32_t channels = acq::allChannels;
+            if (argFlags & ARG_FLAG_ADCSTREAM) { channels &= ~(1u << acq::CH_poti); }
+
+            acq::start(channels);
+        }
 
 #if defined(PRJ_DEBUG) && 0
         constexpr uint64_t dumpPins = RPIHAL_GPIO_BIT(12) | RPIHAL_GPIO_BIT(13) | RPIHAL_GPIO_BIT(14) | RPIHAL_GPIO_BIT(15);
@@ -181,16 +296,53 @@ int main(int argc, char** argv)
 #endif
         )
         {
-            gpio::task();
-            app::task();
-
-            util::sleep(5);
+            static uint64_t tLoop = perf::now();
+            const uint64_t t0 = perf::now();
+            perf::record(perf::P_loopPeriod, t0 - tLoop);
+            tLoop = t0;
+
+            {
+                perf::Probe probe(perf::P_gpioTask);
+                gpio::task();
+            }
+            {
+                perf::Probe probe(perf::P_appTask);
+                app::task();
+            }
+
+            ledBar::task();
+            term::task();
+
+            perf::record(perf::P_loopBusy, perf::now() - t0);
+
+            if (perf::printRequested()) { perf::print(); }
+
+            // sleeps until an input changes or the application has something to do
+            const omw::clock::timepoint_t deadline = std::min({ app::deadline(), gpio::deadline(), ledBar::deadline(), term::deadline() });
+            eventLoop::wait(deadline);
+
+            if (deadline != eventLoop::noDeadline)
+            {
+                const omw::clock::timepoint_t late_us = omw::clock::now() - deadline;
+                if (late_us >= 0) { perf::record(perf::P_wakeupLatency, (uint64_t)late_us * 1000); }
+            }
         }
 
+        acq::stop();
+        adcStream::stop();
+        adcScope::stop();
+
+        perf::print();
+
         adc::deinit();
         gpio::deinit();
         ledBar::deinit();
         temp::deinit();
+        term::deinit();
+        eventLoop::deinit();
+
+        logging::stopBinary();
+        logging::stop();
     }
 
     // demo application
@@ -225,6 +377,83 @@ uint32_t parseArgs(int argc, char** argv)
         else if (arg == "i2c") { flags |= ARG_FLAG_I2C; }
         else if (arg == "all") { flags |= ARG_FLAG_ALL; }
         else if (arg == "app") { flags |= ARG_FLAG_APP; }
+        else if (arg == "rt") { flags |= ARG_FLAG_RT; }
+        else if ((arg.compare(0, 7, "rt-cpu=") == 0) && (arg.length() > 7))
+        {
+            flags |= ARG_FLAG_RT;
+            rtCpu = std::atoi(arg.c_str() + 7);
+        }
+        else if (arg == "pulse") { flags |= ARG_FLAG_PULSE; }
+        else if ((arg.compare(0, 6, "pulse=") == 0) && (arg.length() > 6))
+        {
+            const int window = std::atoi(arg.c_str() + 6);
+            if (window > 0)
+            {
+                flags |= ARG_FLAG_PULSE;
+                pulseWindow_ms = (uint32_t)window;
+            }
+            else { LOG_WRN("invalid pulse window: %s", arg.c_str()); }
+        }
+        else if (arg == "pwm") { flags |= ARG_FLAG_PWM; }
+        else if ((arg.compare(0, 4, "pwm=") == 0) && (arg.length() > 4))
+        {
+            flags |= ARG_FLAG_PWM;
+            pwmFrequency_Hz = (uint32_t)std::atoi(arg.c_str() + 4);
+
+            const size_t sep = arg.find(',');
+            if (sep != std::string::npos) { pwmResolution = (uint32_t)std::atoi(arg.c_str() + sep + 1); }
+        }
+        else if (arg == "adcstream") { flags |= ARG_FLAG_ADCSTREAM; }
+        else if ((arg.compare(0, 10, "adcstream=") == 0) && (arg.length() > 10))
+        {
+            flags |= ARG_FLAG_ADCSTREAM;
+            adcStreamRate_Hz = (uint32_t)std::atoi(arg.c_str() + 10);
+
+            const size_t sep = arg.find(',');
+            if (sep != std::string::npos) { adcStreamBits = std::atoi(arg.c_str() + sep + 1); }
+        }
+        else if ((arg.compare(0, 6, "scope=") == 0) && (arg.length() > 6))
+        {
+            const size_t sep = arg.find(',');
+            long level = -1;
+            bool valid = true;
+
+            // strtol() saturates, so a level out of range is not wrapped into it
+            if (sep != std::string::npos)
+            {
+                char* end;
+                level = std::strtol(arg.c_str() + sep + 1, &end, 10);
+                valid = ((*end == 0) && (end != (arg.c_str() + sep + 1)) && (level >= 0) && (level <= (long)adc::maxValue));
+            }
+
+            if (!valid) { LOG_WRN("invalid scope level: %s", arg.c_str()); }
+            else
+            {
+                flags |= ARG_FLAG_SCOPE;
+                scopeFile = arg.substr(6, (sep != std::string::npos ? sep - 6 : std::string::npos));
+                scopeLevel = (int)level;
+            }
+        }
+        else if (arg == "adc-cs=gpio") { adcCs = adc::CS_gpio; }
+        else if (arg == "adc-cs=kernel") { adcCs = adc::CS_kernel; }
+        else if (arg == "adc-cs=batched") { adcCs = adc::CS_batched; }
+        else if (arg == "bench") { flags |= ARG_FLAG_BENCH; }
+        else if ((arg.compare(0, 6, "bench=") == 0) && (arg.length() > 6))
+        {
+            flags |= ARG_FLAG_BENCH;
+            benchFilter = arg.substr(6);
+        }
+        else if ((arg.compare(0, 7, "binlog=") == 0) && (arg.length() > 7)) { binlogFile = arg.substr(7); }
+        else if ((arg.compare(0, 9, "loglevel=") == 0) && (arg.length() > 9))
+        {
+            if (logging::setLevels(arg.c_str() + 9) != 0) { LOG_WRN("invalid log level option: %s", arg.c_str()); }
+        }
+        else if ((arg.compare(0, 8, "lograte=") == 0) && (arg.length() > 8))
+        {
+            const int rate = std::atoi(arg.c_str() + 8);
+            if (rate > 0) { logging::setRateLimit((uint32_t)rate, 1000, 10000); }
+            else { logging::setRateLimit(0, 0, 0); }
+        }
         else { LOG_WRN("ignoring unknown option: %s", arg.c_str()); }
     }
 
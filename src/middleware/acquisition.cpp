@@ -0,0 +1,181 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "acquisition.h"
+#include "middleware/adc.h"
+#include "middleware/perf.h"
+#include "middleware/seqlock.h"
+#include "middleware/temperature.h"
+#include "middleware/util.h"
+
+#include <rpihal/sys.h>
+
+
+#define LOG_MODULE_LEVEL LOG_LEVEL_INF
+#define LOG_MODULE_NAME  ACQ
+#include "middleware/log.h"
+
+
+static constexpr uint64_t potiPeriod_ns = 10ull * 1000 * 1000;
+static constexpr uint64_t cpuTempPeriod_ns = 500ull * 1000 * 1000;
+static constexpr uint64_t pcbTempPeriod_ns = 220ull * 1000 * 1000; // conversion time of the TMP1075 in continuous mode
+
+// the TMP1075 range is [-55, 125] degC, temp::get() returns large negative values on error
+static constexpr float pcbTempMin = -55.0f;
+
+
+
+namespace {
+
+typedef bool (*acquire_func_t)(acq::Snapshot& snapshot);
+
+struct Worker
+{
+    std::thread thread;
+    acquire_func_t acquire;
+    uint64_t period_ns;
+    int channel;
+};
+
+}
+
+static std::atomic<bool> run(false);
+static util::Seqlock<acq::Snapshot> snapshots[acq::CH__end_];
+static Worker workers[acq::CH__end_];
+
+static bool acquirePoti(acq::Snapshot& snapshot);
+static bool acquireCpuTemp(acq::Snapshot& snapshot);
+static bool acquirePcbTemp(acq::Snapshot& snapshot);
+static void workerThread(Worker* worker);
+
+
+
+int acq::start(uint32_t channels)
+{
+    if (run) { return 0; }
+
+    // one worker per bus, so the buses are read in parallel
+    workers[CH_poti].acquire = acquirePoti;
+    workers[CH_poti].period_ns = potiPeriod_ns;
+    workers[CH_cpuTemp].acquire = acquireCpuTemp;
+    workers[CH_cpuTemp].period_ns = cpuTempPeriod_ns;
+    workers[CH_pcbTemp].acquire = acquirePcbTemp;
+    workers[CH_pcbTemp].period_ns = pcbTempPeriod_ns;
+
+    run = true;
+
+    for (int i = 0; i < CH__end_; ++i)
+    {
+        workers[i].channel = i;
+        if (channels & (1u << i)) { workers[i].thread = std::thread(workerThread, &workers[i]); }
+    }
+
+    return 0;
+}
+
+void acq::stop()
+{
+    run = false;
+
+    for (int i = 0; i < CH__end_; ++i)
+    {
+        if (workers[i].thread.joinable()) { workers[i].thread.join(); }
+    }
+}
+
+bool acq::get(int channel, Snapshot& snapshot)
+{
+    if ((channel < 0) || (channel >= CH__end_))
+    {
+        LOG_ERR("invalid channel %i", channel);
+        return false;
+    }
+
+    // the worker publishes failed acquisitions too, `seq` is 0 until the first one succeeded
+    return ((snapshots[channel].read(snapshot) != 0) && (snapshot.seq != 0));
+}
+
+
+
+bool acquirePoti(acq::Snapshot& snapshot)
+{
+    perf::Probe probe(perf::P_adcRead);
+
+    adc::Result r;
+    const bool ok = (adc::readPoti(r) == 0);
+
+    if (ok)
+    {
+        snapshot.value = r.norm();
+        snapshot.raw = r.value();
+    }
+
+    return ok;
+}
+
+bool acquireCpuTemp(acq::Snapshot& snapshot)
+{
+    perf::Probe probe(perf::P_cpuTemp);
+
+    float temp;
+    const bool ok = (RPIHAL_SYS_getCpuTemp(&temp) == 0);
+
+    if (ok) { snapshot.value = temp; }
+    snapshot.raw = 0;
+
+    return ok;
+}
+
+bool acquirePcbTemp(acq::Snapshot& snapshot)
+{
+    perf::Probe probe(perf::P_pcbTemp);
+
+    const float temp = temp::get();
+    const bool ok = (temp >= pcbTempMin);
+
+    if (ok) { snapshot.value = temp; }
+    snapshot.raw = 0;
+
+    return ok;
+}
+
+void workerThread(Worker* worker)
+{
+    util::Seqlock<acq::Snapshot>& seqlock = snapshots[worker->channel];
+
+    acq::Snapshot snapshot;
+    snapshot.value = 0;
+    snapshot.raw = 0;
+    snapshot.valid = false;
+    snapshot.t_ns = 0;
+    snapshot.seq = 0;
+
+    uint64_t next = util::monotonic_ns();
+
+    while (run)
+    {
+        const uint64_t t = util::monotonic_ns();
+
+        if (worker->acquire(snapshot))
+        {
+            snapshot.valid = true;
+            snapshot.t_ns = t;
+            ++snapshot.seq;
+        }
+        else { snapshot.valid = false; } // keeps the last value and its timestamp
+
+        seqlock.write(snapshot);
+
+        // absolute wakeup times, a slow bus transaction does not shift the period
+        next += worker->period_ns;
+        if (next < util::monotonic_ns()) { next = util::monotonic_ns(); }
+        util::sleep_until(next);
+    }
+}
@@ -0,0 +1,58 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_ACQUISITION_H
+#define IG_MIDDLEWARE_ACQUISITION_H
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace acq {
+
+enum CHANNEL
+{
+    CH_poti = 0, // SPI, MCP3004 channel 0
+    CH_cpuTemp,  // sysfs
+    CH_pcbTemp,  // I2C, TMP1075
+
+    CH__end_
+};
+
+constexpr uint32_t allChannels = (1u << CH__end_) - 1;
+
+struct Snapshot
+{
+    float value;   // normalised value for ADC channels, degC for temperatures
+    uint16_t raw;  // raw ADC value, 0 for temperatures
+    bool valid;    // `false` if the last acquisition failed, `value` is from the last successful one
+    uint64_t t_ns; // acquisition time (`util::monotonic_ns()`) of `value`
+    uint32_t seq;  // number of the snapshot, incremented by each successful acquisition
+};
+
+/**
+ * @brief Starts one worker thread per bus.
+ *
+ * The drivers (`adc`, `temp`) have to be initialised before.
+ *
+ * @param channels Bit mask of the acquired channels (`1 << acq::CHANNEL`), `acq::get()` returns `false` for the others
+ * @return 0 on success
+ */
+int start(uint32_t channels = allChannels);
+
+void stop();
+
+/**
+ * @brief Returns the latest snapshot of a channel, never blocks on hardware.
+ *
+ * @param channel Channel ID (`acq::CHANNEL`)
+ * @return `false` if no value has been acquired yet
+ */
+bool get(int channel, Snapshot& snapshot);
+
+} // namespace acq
+
+
+#endif // IG_MIDDLEWARE_ACQUISITION_H
@@ -0,0 +1,61 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+#include "adc-convert.h"
+#include "adc.h"
+
+
+#define LOG_MODULE_LEVEL LOG_LEVEL_INF
+#define LOG_MODULE_NAME  ADCCONV
+#include "middleware/log.h"
+
+
+static constexpr size_t maxDecimation = 64; // the block sum of 10 bit values fits in 16 bit
+
+
+
+void adc::normalise(const uint16_t* raw, float* dst, size_t count)
+{
+    constexpr float k = 1.0f / (float)maxValue;
+
+    for (size_t i = 0; i < count; ++i) { dst[i] = (float)raw[i] * k; }
+}
+
+void adc::normaliseQ15(const uint16_t* raw, uint16_t* dst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) { dst[i] = (uint16_t)(((uint32_t)raw[i] * q15Factor + 0x8000) >> 16); }
+}
+
+void adc::scale(const uint16_t* raw, float* dst, size_t count, float gain, float offset)
+{
+    for (size_t i = 0; i < count; ++i) { dst[i] = (float)raw[i] * gain + offset; }
+}
+
+size_t adc::decimate(const uint16_t* raw, uint16_t* dst, size_t count, size_t factor)
+{
+    if ((factor < 1) || (factor > maxDecimation))
+    {
+        LOG_ERR("invalid factor %zu", factor);
+        return 0;
+    }
+
+    const size_t n = count / factor;
+    const uint16_t half = (uint16_t)(factor / 2);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const uint16_t* block = raw + i * factor;
+        uint16_t sum = half;
+
+        for (size_t k = 0; k < factor; ++k) { sum += block[k]; }
+
+        dst[i] = (uint16_t)(sum / factor);
+    }
+
+    return n;
+}
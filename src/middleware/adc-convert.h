@@ -0,0 +1,47 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_ADCCONVERT_H
+#define IG_MIDDLEWARE_ADCCONVERT_H
+
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * Bulk conversion of raw 10 bit values, e.g. of streamed or captured samples.
+ *
+ * The loops have no dependencies between the elements and no branches, so the compiler vectorises them (SSE, NEON).
+ * The source and the destination must not overlap.
+ */
+namespace adc {
+
+/**
+ * @brief `dst[i] = raw[i] / adc::maxValue`, same as `adc::Result::norm()`.
+ */
+void normalise(const uint16_t* raw, float* dst, size_t count);
+
+/**
+ * @brief Normalises to Q15 (1.0 is 32768), same as `adc::Result::normQ15()`.
+ */
+void normaliseQ15(const uint16_t* raw, uint16_t* dst, size_t count);
+
+/**
+ * @brief `dst[i] = raw[i] * gain + offset`, e.g. to convert to volts.
+ */
+void scale(const uint16_t* raw, float* dst, size_t count, float gain, float offset = 0);
+
+/**
+ * @brief Averages blocks of `factor` values.
+ *
+ * @param factor [1, 64]
+ * @return Number of values written to `dst`, `count / factor`, the remaining values are ignored
+ */
+size_t decimate(const uint16_t* raw, uint16_t* dst, size_t count, size_t factor);
+
+} // namespace adc
+
+
+#endif // IG_MIDDLEWARE_ADCCONVERT_H
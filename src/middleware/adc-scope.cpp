@@ -0,0 +1,335 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "adc-scope.h"
+#include "adc.h"
+#include "middleware/seqlock.h"
+#include "middleware/util.h"
+
+#include <rpihal/gpio.h>
+
+
+#define LOG_MODULE_LEVEL LOG_LEVEL_INF
+#define LOG_MODULE_NAME  ADCSCOPE
+#include "middleware/log.h"
+
+
+namespace {
+
+struct Sample
+{
+    uint64_t t_ns;
+    uint16_t raw;
+};
+
+enum STATE
+{
+    S_armed = 0, // filling the pre-trigger buffer and waiting for the trigger
+    S_post,      // taking the post-trigger samples
+    S_idle,      // waiting for `adcScope::arm()`
+};
+
+// edge detection with hysteresis on the ADC value
+struct LevelTrigger
+{
+    int level;
+    int hysteresis;
+    int edges;
+    bool lowArmed;  // the signal was below `level - hysteresis`
+    bool highArmed; // the signal was above `level + hysteresis`
+
+    bool update(int value)
+    {
+        bool r = false;
+
+        if ((edges & adcScope::E_rising) && lowArmed && (value >= level))
+        {
+            lowArmed = false;
+            r = true;
+        }
+
+        if ((edges & adcScope::E_falling) && highArmed && (value <= level))
+        {
+            highArmed = false;
+            r = true;
+        }
+
+        if (value <= (level - hysteresis)) { lowArmed = true; }
+        if (value >= (level + hysteresis)) { highArmed = true; }
+
+        return r;
+    }
+};
+
+}
+
+
+
+static std::thread thread;
+static std::atomic<bool> run(false);
+static std::atomic<bool> softTrigger(false);
+static std::atomic<bool> armRequest(false);
+static adcScope::Config config = adcScope::defaultConfig();
+static std::string file;
+
+static Sample buffer[adcScope::maxSamples];
+static util::Seqlock<adcScope::Info> infoSeqlock;
+
+static void scopeThread();
+static int writeCapture(size_t trigPos, uint32_t number);
+
+
+
+int adcScope::start(const Config& cfg)
+{
+    if (run) { return 0; }
+
+    if ((cfg.channel >= adc::channelCount) || (cfg.rate_Hz == 0) || (((size_t)cfg.preTrigger + cfg.postTrigger + 1) > maxSamples) ||
+        ((cfg.edges & E_both) == 0) || (cfg.pin >= 64) || !cfg.file || (cfg.file[0] == 0))
+    {
+        LOG_ERR("invalid config");
+        return -(__LINE__);
+    }
+
+    config = cfg;
+    file = cfg.file;
+    config.file = file.c_str();
+
+    Info info;
+    std::memset(&info, 0, sizeof(info));
+    infoSeqlock.write(info);
+
+    softTrigger = false;
+    armRequest = false;
+
+    run = true;
+    thread = std::thread(scopeThread);
+
+    if (cfg.priority > 0)
+    {
+        const int err = util::setThreadPriority(thread, cfg.priority);
+        if (err) { LOG_WRN("failed to set SCHED_FIFO priority %i, err: %i %s", cfg.priority, err, std::strerror(err)); }
+    }
+
+    if (cfg.pin >= 0) { LOG_INF("CH%u, %uHz, %u+%u samples, trigger GPIO%i", cfg.channel, cfg.rate_Hz, cfg.preTrigger, cfg.postTrigger, cfg.pin); }
+    else { LOG_INF("CH%u, %uHz, %u+%u samples, trigger level %u", cfg.channel, cfg.rate_Hz, cfg.preTrigger, cfg.postTrigger, cfg.level); }
+
+    return 0;
+}
+
+void adcScope::stop()
+{
+    if (!run) { return; }
+
+    run = false;
+    if (thread.joinable()) { thread.join(); }
+
+    const Info i = info();
+    LOG_INF("%u captures, %llu samples, %llu errors", i.captures, (unsigned long long)i.samples, (unsigned long long)i.errors);
+}
+
+bool adcScope::running() { return run; }
+
+void adcScope::trigger() { softTrigger = true; }
+
+void adcScope::arm() { armRequest = true; }
+
+adcScope::Info adcScope::info()
+{
+    Info i;
+    infoSeqlock.read(i);
+    return i;
+}
+
+
+
+void scopeThread()
+{
+    const uint8_t channelMask = (uint8_t)(1u << config.channel);
+    const uint32_t pre = config.preTrigger;
+    const uint32_t post = config.postTrigger;
+    const uint64_t period_ns = 1000000000ull / config.rate_Hz;
+    const int pin = config.pin;
+
+    adcScope::Info info;
+    std::memset(&info, 0, sizeof(info));
+
+    LevelTrigger levelTrigger;
+    levelTrigger.level = config.level;
+    levelTrigger.hysteresis = config.hysteresis;
+    levelTrigger.edges = config.edges;
+
+    adc::Result results[adc::channelCount];
+
+    int state = S_armed;
+    size_t pos = 0;
+    size_t trigPos = 0;
+    uint32_t filled = 0; // samples in the pre-trigger buffer
+    uint32_t remaining = 0;
+    bool pinLevel = false;
+
+    bool restart = true;
+    uint64_t next = 0;
+    uint64_t tInfo = util::monotonic_ns();
+
+    while (run)
+    {
+        if (state == S_idle)
+        {
+            if (armRequest.exchange(false))
+            {
+                state = S_armed;
+                restart = true;
+            }
+            else
+            {
+                util::sleep(10);
+                continue;
+            }
+        }
+
+        if (restart)
+        {
+            // nothing of the previous capture is reused
+            restart = false;
+            filled = 0;
+            levelTrigger.lowArmed = false;
+            levelTrigger.highArmed = false;
+            if (pin >= 0) { pinLevel = (RPIHAL_GPIO_readPin(pin) > 0); }
+            softTrigger = false;
+
+            info.armed = true;
+            infoSeqlock.write(info);
+
+            next = util::monotonic_ns();
+        }
+
+        next += period_ns;
+        util::sleep_until(next);
+
+        uint64_t t_ns;
+
+        if (adc::scan(channelMask, results, &t_ns))
+        {
+            ++info.errors;
+            continue;
+        }
+
+        ++info.samples;
+
+        Sample& sample = buffer[pos];
+        sample.t_ns = t_ns;
+        sample.raw = results[config.channel].value();
+
+        bool complete = false;
+
+        if (state == S_armed)
+        {
+            bool edge;
+
+            if (pin >= 0)
+            {
+                const bool level = (RPIHAL_GPIO_readPin(pin) > 0);
+                edge = ((level && !pinLevel && (config.edges & adcScope::E_rising)) || (!level && pinLevel && (config.edges & adcScope::E_falling)));
+                pinLevel = level;
+            }
+            else { edge = levelTrigger.update(sample.raw); }
+
+            // the trigger is held off until the pre-trigger window is complete
+            if ((filled >= pre) && (edge || softTrigger.exchange(false)))
+            {
+                state = S_post;
+                trigPos = pos;
+                remaining = post;
+                complete = (post == 0);
+            }
+            else if (filled < pre) { ++filled; }
+        }
+        else
+        {
+            --remaining;
+            complete = (remaining == 0);
+        }
+
+        pos = (pos + 1) % adcScope::maxSamples;
+
+        if (complete)
+        {
+            info.trigger_ns = buffer[trigPos].t_ns;
+            info.armed = false;
+
+            if (writeCapture(trigPos, info.captures + 1) == 0) { ++info.captures; }
+            infoSeqlock.write(info);
+
+            if (config.rearm)
+            {
+                state = S_armed;
+                restart = true;
+            }
+            else { state = S_idle; }
+        }
+
+        const uint64_t now = util::monotonic_ns();
+
+        if ((now - tInfo) >= 1000000000ull)
+        {
+            infoSeqlock.write(info);
+            tInfo = now;
+        }
+
+        // don't catch up after a stall
+        if (now > (next + period_ns)) { next = now; }
+    }
+
+    infoSeqlock.write(info);
+}
+
+int writeCapture(size_t trigPos, uint32_t number)
+{
+    std::FILE* fp = std::fopen(file.c_str(), "a");
+
+    if (!fp)
+    {
+        LOG_ERR("failed to open \"%s\", err: %i %s", file.c_str(), errno, std::strerror(errno));
+        return -(__LINE__);
+    }
+
+    const uint64_t trigger_ns = buffer[trigPos].t_ns;
+    const size_t first = (trigPos + adcScope::maxSamples - config.preTrigger) % adcScope::maxSamples;
+    const size_t count = (size_t)config.preTrigger + config.postTrigger + 1;
+
+    std::fprintf(fp, "# capture %u, CH%u, %uHz, trigger %llu ns\n", number, config.channel, config.rate_Hz, (unsigned long long)trigger_ns);
+    std::fprintf(fp, "index,t_ns,raw\n");
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Sample& s = buffer[(first + i) % adcScope::maxSamples];
+        std::fprintf(fp, "%lli,%lli,%u\n", (long long)i - (long long)config.preTrigger, (long long)s.t_ns - (long long)trigger_ns, s.raw);
+    }
+
+    std::fprintf(fp, "\n");
+
+    const bool err = (std::ferror(fp) != 0);
+    std::fclose(fp);
+
+    if (err)
+    {
+        LOG_ERR("failed to write \"%s\"", file.c_str());
+        return -(__LINE__);
+    }
+
+    LOG_INF("capture %u written", number);
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_ADCSCOPE_H
+#define IG_MIDDLEWARE_ADCSCOPE_H
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace adcScope {
+
+// capacity of the capture buffer, pre-trigger + post-trigger + the trigger sample
+constexpr size_t maxSamples = 16384;
+
+enum EDGE
+{
+    E_rising = 0x01,
+    E_falling = 0x02,
+    E_both = (E_rising | E_falling),
+};
+
+struct Config
+{
+    uint8_t channel;      // ADC channel [0, 3]
+    uint32_t rate_Hz;     // samples per second
+    uint32_t preTrigger;  // samples before the trigger sample
+    uint32_t postTrigger; // samples after the trigger sample
+    int pin;              // trigger on an edge of this GPIO, negative to trigger on the ADC level
+    int edges;            // trigger edges (`adcScope::EDGE`)
+    uint16_t level;       // raw trigger level of the ADC trigger
+    uint16_t hysteresis;  // the signal has to pass `level -/+ hysteresis` before an edge is armed, suppresses noise triggers
+    bool rearm;           // arm again after the capture has been written, otherwise only one capture is taken
+    int priority;         // SCHED_FIFO priority [1, 99], 0 for the default policy
+    const char* file;     // the captures are appended to this file as CSV
+};
+
+struct Info
+{
+    uint32_t captures;   // written captures
+    uint64_t trigger_ns; // time of the last trigger sample (`util::monotonic_ns()`)
+    uint64_t samples;    // samples since start
+    uint64_t errors;     // failed conversions
+    bool armed;
+};
+
+static inline Config defaultConfig()
+{
+    Config cfg;
+    cfg.channel = 0;
+    cfg.rate_Hz = 10000;
+    cfg.preTrigger = 1000;
+    cfg.postTrigger = 4000;
+    cfg.pin = -1;
+    cfg.edges = E_rising;
+    cfg.level = 512;
+    cfg.hysteresis = 8;
+    cfg.rearm = true;
+    cfg.priority = 0;
+    cfg.file = nullptr;
+    return cfg;
+}
+
+/**
+ * @brief Starts sampling a channel into a circular pre-trigger buffer on a separate thread.
+ *
+ * On the trigger the pre-trigger samples are frozen and the post-trigger samples are added, then the window is written
+ * to the file with the time of each sample relative to the trigger. The buffer is static, nothing is allocated while
+ * armed. Sampling pauses while the capture is written.
+ *
+ * `adc::init()` has to be called before, and the trigger pin has to be initialised as input.
+ *
+ * @return 0 on success
+ */
+int start(const Config& cfg);
+
+void stop();
+
+bool running();
+
+/**
+ * @brief Triggers by software, the trigger sample is the next one taken.
+ */
+void trigger();
+
+/**
+ * @brief Arms again after a capture if `Config::rearm` is not set.
+ */
+void arm();
+
+Info info();
+
+} // namespace adcScope
+
+
+#endif // IG_MIDDLEWARE_ADCSCOPE_H
@@ -0,0 +1,225 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include "adc-stream.h"
+#include "adc.h"
+#include "middleware/seqlock.h"
+#include "middleware/spsc-queue.h"
+#include "middleware/util.h"
+
+
+#define LOG_MODULE_LEVEL LOG_LEVEL_INF
+#define LOG_MODULE_NAME  ADCSTRM
+#include "middleware/log.h"
+
+
+namespace {
+
+// pipeline state of one channel
+struct Pipeline
+{
+    uint32_t sum; // oversampling accumulator
+    uint64_t t_ns;
+
+    uint16_t ma[adcStream::maxMovingAverage];
+    uint32_t maSum;
+    uint32_t maPos;
+    uint32_t maCnt;
+
+    float iir;
+    bool iirValid;
+};
+
+}
+
+
+
+static std::thread thread;
+static std::atomic<bool> run(false);
+static adcStream::Config config = adcStream::defaultConfig();
+
+static Pipeline pipelines[adc::channelCount];
+static util::SpscQueue<adcStream::Sample, 4096> queue;
+static util::Seqlock<adcStream::Stats> statsSeqlock;
+
+static void streamThread();
+
+
+
+int adcStream::start(const Config& cfg)
+{
+    if (run) { return 0; }
+
+    if (((cfg.channels & ((1u << adc::channelCount) - 1)) == 0) || (cfg.oversampleBits > maxOversampleBits) || (cfg.movingAverage < 1) ||
+        (cfg.movingAverage > maxMovingAverage) || !(cfg.iirAlpha > 0) || (cfg.iirAlpha > 1))
+    {
+        LOG_ERR("invalid config");
+        return -(__LINE__);
+    }
+
+    config = cfg;
+    std::memset(pipelines, 0, sizeof(pipelines));
+    statsSeqlock.write(Stats());
+
+    Sample dummy;
+    while (queue.pop(dummy)) {}
+
+    run = true;
+    thread = std::thread(streamThread);
+
+    if (cfg.priority > 0)
+    {
+        const int err = util::setThreadPriority(thread, cfg.priority);
+        if (err) { LOG_WRN("failed to set SCHED_FIFO priority %i, err: %i %s", cfg.priority, err, std::strerror(err)); }
+    }
+
+    return 0;
+}
+
+void adcStream::stop()
+{
+    if (!run) { return; }
+
+    run = false;
+    if (thread.joinable()) { thread.join(); }
+
+    const Stats s = stats();
+    LOG_INF("%.0f scans/s, %.1f samples/s per channel, %llu samples, %llu dropped, %llu errors", s.scanRate_Hz, s.sampleRate_Hz,
+            (unsigned long long)s.samples, (unsigned long long)s.dropped, (unsigned long long)s.errors);
+}
+
+bool adcStream::running() { return run; }
+
+bool adcStream::pop(Sample& sample) { return queue.pop(sample); }
+
+adcStream::Stats adcStream::stats()
+{
+    Stats s;
+    statsSeqlock.read(s);
+    return s;
+}
+
+
+
+void streamThread()
+{
+    const uint8_t channels = config.channels;
+    const unsigned osBits = config.oversampleBits;
+    const uint32_t osCount = 1u << (2 * osBits); // 4^n
+    const uint32_t maLen = config.movingAverage;
+    const float alpha = config.iirAlpha;
+    const uint64_t period_ns = (config.rate_Hz > 0 ? 1000000000ull / config.rate_Hz : 0);
+
+    adcStream::Stats stats;
+    std::memset(&stats, 0, sizeof(stats));
+
+    adc::Result results[adc::channelCount];
+    uint32_t osCnt = 0;
+
+    uint64_t scans = 0;
+    uint64_t decimated = 0;
+    uint64_t next = util::monotonic_ns();
+    uint64_t tStats = next;
+
+    while (run)
+    {
+        if (period_ns)
+        {
+            next += period_ns;
+            util::sleep_until(next);
+        }
+
+        uint64_t t_ns;
+
+        if (adc::scan(channels, results, &t_ns))
+        {
+            ++stats.errors;
+            continue;
+        }
+
+        ++scans;
+
+        for (uint8_t ch = 0; ch < adc::channelCount; ++ch)
+        {
+            if ((channels & (1u << ch)) == 0) { continue; }
+
+            Pipeline& p = pipelines[ch];
+
+            if (osCnt == 0) { p.t_ns = t_ns; }
+            p.sum += results[ch].value();
+        }
+
+        if (++osCnt >= osCount)
+        {
+            osCnt = 0;
+            ++decimated;
+
+            for (uint8_t ch = 0; ch < adc::channelCount; ++ch)
+            {
+                if ((channels & (1u << ch)) == 0) { continue; }
+
+                Pipeline& p = pipelines[ch];
+
+                // oversample and decimate, the sum of 4^n samples has 10 + 2n bits, n of them are noise
+                const uint16_t raw = (uint16_t)(p.sum >> osBits);
+                p.sum = 0;
+
+                // moving average, running sum over a ring
+                if (p.maCnt == maLen) { p.maSum -= p.ma[p.maPos]; }
+                else { ++p.maCnt; }
+
+                p.ma[p.maPos] = raw;
+                p.maSum += raw;
+                p.maPos = (p.maPos + 1) % maLen;
+
+                const float avg = (float)p.maSum / (float)p.maCnt;
+
+                // first order IIR
+                if (!p.iirValid)
+                {
+                    p.iir = avg;
+                    p.iirValid = true;
+                }
+                else { p.iir += alpha * (avg - p.iir); }
+
+                adcStream::Sample sample;
+                sample.t_ns = p.t_ns;
+                sample.value = p.iir;
+                sample.raw = raw;
+                sample.channel = ch;
+                sample.bits = (uint8_t)(10 + osBits);
+
+                if (queue.push(sample)) { ++stats.samples; }
+                else { ++stats.dropped; }
+            }
+        }
+
+        const uint64_t now = util::monotonic_ns();
+
+        if ((now - tStats) >= 1000000000ull)
+        {
+            const double dt = (double)(now - tStats) * 1e-9;
+
+            stats.scanRate_Hz = (double)scans / dt;
+            stats.sampleRate_Hz = (double)decimated / dt;
+            statsSeqlock.write(stats);
+
+            scans = 0;
+            decimated = 0;
+            tStats = now;
+        }
+
+        // don't catch up after a stall
+        if (period_ns && (now > (next + period_ns))) { next = now; }
+    }
+
+    statsSeqlock.write(stats);
+}
@@ -0,0 +1,90 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_ADCSTREAM_H
+#define IG_MIDDLEWARE_ADCSTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace adcStream {
+
+constexpr unsigned maxOversampleBits = 6;
+constexpr uint32_t maxMovingAverage = 64;
+
+struct Config
+{
+    uint8_t channels;         // bit mask of the ADC channels, bit 0 is channel 0
+    uint32_t rate_Hz;         // scans per second, 0 to scan back to back (starves the other users of the SPI bus)
+    unsigned oversampleBits;  // [0, `maxOversampleBits`], 4^n scans are summed up and decimated to 10 + n bits
+    uint32_t movingAverage;   // [1, `maxMovingAverage`] length of the moving average over the decimated values, 1 to disable
+    float iirAlpha;           // (0, 1] coefficient of the first order IIR filter `y += alpha * (x - y)`, 1 to disable
+    int priority;             // SCHED_FIFO priority [1, 99], 0 for the default policy
+};
+
+struct Sample
+{
+    uint64_t t_ns;  // time of the first scan of the decimated value (`util::monotonic_ns()`)
+    float value;    // filtered value in LSB of `bits`
+    uint16_t raw;   // decimated value before the moving average and the IIR filter
+    uint8_t channel;
+    uint8_t bits;   // resolution, 10 + `Config::oversampleBits`
+};
+
+struct Stats
+{
+    double scanRate_Hz;   // achieved scans per second
+    double sampleRate_Hz; // output samples per second and channel
+    uint64_t samples;     // output samples since start
+    uint64_t dropped;     // output samples dropped because the queue was full
+    uint64_t errors;      // failed scans
+};
+
+static inline Config defaultConfig()
+{
+    Config cfg;
+    cfg.channels = 0x01;
+    cfg.rate_Hz = 8000;
+    cfg.oversampleBits = 2;
+    cfg.movingAverage = 4;
+    cfg.iirAlpha = 0.25f;
+    cfg.priority = 0;
+    return cfg;
+}
+
+/**
+ * @brief Starts sampling the channels on a separate thread.
+ *
+ * The channels are converted together with `adc::scan()`. The samples pass the pipeline oversample and decimate,
+ * moving average and IIR filter, and are put into a lock-free queue, from which the application pops them with
+ * `adcStream::pop()`. The pipeline is allocation free.
+ *
+ * `adc::init()` has to be called before.
+ *
+ * @return 0 on success
+ */
+int start(const Config& cfg);
+
+void stop();
+
+bool running();
+
+/**
+ * @brief Pops the oldest sample, must only be called from one thread.
+ *
+ * @return `false` if no sample is pending
+ */
+bool pop(Sample& sample);
+
+/**
+ * @brief Returns the statistics of the stream, updated once per second.
+ */
+Stats stats();
+
+} // namespace adcStream
+
+
+#endif // IG_MIDDLEWARE_ADCSTREAM_H
@@ -7,12 +7,20 @@ copyright       MIT - Copyright (c) 2025 Oliver Blaser
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <mutex>
 
 #include "adc.h"
+#include "middleware/util.h"
+#include "spi-bus.h"
 
 #include <rpihal/gpio.h>
 #include <rpihal/spi.h>
 
+#ifndef RPIHAL_EMU
+#include <linux/spi/spidev.h>
+#include <sys/ioctl.h>
+#endif // RPIHAL_EMU
+
 
 #define LOG_MODULE_LEVEL LOG_LEVEL_INF
 #define LOG_MODULE_NAME  ADC
@@ -27,6 +35,11 @@ copyright       MIT - Copyright (c) 2025 Oliver Blaser
 
 static RPIHAL_SPI_instance_t ___spi;
 static RPIHAL_SPI_instance_t* const spi = &___spi;
+static int cs = adc::CS_batched;
+
+static void fillTx(uint8_t* txBuffer, uint8_t channel);
+static uint16_t parseRx(const uint8_t* rxBuffer);
+static int transfer(const uint8_t* txBuffer, uint8_t* rxBuffer); // one conversion, the bus has to be locked
 
 
 
@@ -36,29 +49,43 @@ extern "C" int adc_spi_emu_transfer_callback(const uint8_t* txData, uint8_t* rxB
 
 
 
-int adc::init()
+int adc::init(int csMode)
 {
     int err;
 
-    err = RPIHAL_GPIO_init();
-    if (err)
+    if ((csMode != CS_gpio) && (csMode != CS_kernel) && (csMode != CS_batched))
     {
-        LOG_ERR("RPIHAL_GPIO_init() failed: %i", err);
+        LOG_ERR("invalid chip select mode %i", csMode);
         return -(__LINE__);
     }
 
-    RPIHAL_GPIO_init_t initStruct;
-    initStruct.mode = RPIHAL_GPIO_MODE_OUT;
-    initStruct.pull = RPIHAL_GPIO_PULL_NONE;
-    RPIHAL_GPIO_writePin(PIN_nCS, 1);
-    err = RPIHAL_GPIO_initPin(PIN_nCS, &initStruct);
-    if (err)
+    cs = csMode;
+
+    if (cs == CS_gpio)
     {
-        LOG_ERR("failed to init latch pin: %i", err);
-        return -(__LINE__);
+        err = RPIHAL_GPIO_init();
+        if (err)
+        {
+            LOG_ERR("RPIHAL_GPIO_init() failed: %i", err);
+            return -(__LINE__);
+        }
+
+        RPIHAL_GPIO_init_t initStruct;
+        initStruct.mode = RPIHAL_GPIO_MODE_OUT;
+        initStruct.pull = RPIHAL_GPIO_PULL_NONE;
+        RPIHAL_GPIO_writePin(PIN_nCS, 1);
+        err = RPIHAL_GPIO_initPin(PIN_nCS, &initStruct);
+        if (err)
+        {
+            LOG_ERR("failed to init nCS pin: %i", err);
+            return -(__LINE__);
+        }
+
+        spiBus::spi0Flags() = (RPIHAL_SPI_CFG_MODE_0 | RPIHAL_SPI_CFG_NO_CS);
     }
+    else { spiBus::spi0Flags() = RPIHAL_SPI_CFG_MODE_0; }
 
-    err = RPIHAL_SPI_open(spi, "/dev/spidev0.0", MAX_CLOCK_FREQ, RPIHAL_SPI_CFG_MODE_0 | RPIHAL_SPI_CFG_NO_CS);
+    err = RPIHAL_SPI_open(spi, "/dev/spidev0.0", MAX_CLOCK_FREQ, spiBus::spi0Flags());
     if (err)
     {
         LOG_ERR("failed to open SPI, err: %i, errno: %i %s", err, errno, std::strerror(errno));
@@ -76,46 +103,146 @@ void adc::deinit()
 {
     int err;
 
-    err = RPIHAL_GPIO_resetPin(PIN_nCS);
-    if (err) { LOG_ERR("failed to deinit latch pin: %i", err); }
+    if (cs == CS_gpio)
+    {
+        err = RPIHAL_GPIO_resetPin(PIN_nCS);
+        if (err) { LOG_ERR("failed to deinit nCS pin: %i", err); }
+    }
 
     err = RPIHAL_SPI_close(spi);
     if (err) { LOG_ERR("failed to close SPI, err: %i, errno: %i %s", err, errno, std::strerror(errno)); }
 }
 
-adc::Result adc::read(uint8_t channel)
-{
-    Result r(0);
+int adc::csMode() { return cs; }
 
+int adc::read(uint8_t channel, Result& result)
+{
     int err;
 
     uint8_t rxBuffer[3];
     uint8_t txBuffer[3];
 
-    txBuffer[0] = 0x01;
-    txBuffer[1] = (0x80 | ((channel & 0x03) << 4));
+    fillTx(txBuffer, channel);
 
-    RPIHAL_GPIO_writePin(PIN_nCS, 0);
-    err = RPIHAL_SPI_transfer(spi, txBuffer, rxBuffer, 3);
-    RPIHAL_GPIO_writePin(PIN_nCS, 1);
+    {
+        std::lock_guard<std::mutex> lock(spiBus::spi0());
+        err = transfer(txBuffer, rxBuffer);
+    }
 
     if (err)
     {
         LOG_DBG("ch: %i, tx[1]: 0x%02x", (int)channel, (int)(txBuffer[1]));
         LOG_ERR("failed to read channel, err: %i, errno: %i %s", err, errno, std::strerror(errno));
+        return -(__LINE__);
+    }
+
+    result = parseRx(rxBuffer);
+
+    LOG_DBG("ch: %i, tx[1]: 0x%02x, r.value: 0x%03x %4i, r.norm: %5.1f", (int)channel, (int)(txBuffer[1]), (int)result.value(), (int)result.value(),
+            (double)result.norm());
+
+    return 0;
+}
+
+int adc::scan(uint8_t channels, Result* results, uint64_t* t_ns)
+{
+    uint8_t txBuffer[channelCount][3];
+    uint8_t rxBuffer[channelCount][3];
+    uint8_t map[channelCount];
+    size_t n = 0;
+
+    for (uint8_t ch = 0; ch < channelCount; ++ch)
+    {
+        if (channels & (1u << ch))
+        {
+            fillTx(txBuffer[n], ch);
+            map[n] = ch;
+            ++n;
+        }
     }
-    else
+
+    if (n == 0) { return 0; }
+
+    int err = 0;
+
     {
-        uint16_t value = (uint16_t)(rxBuffer[1] & 0x03);
-        value <<= 8;
-        value |= (uint16_t)(rxBuffer[2]);
+        std::lock_guard<std::mutex> lock(spiBus::spi0());
 
-        r = value;
+        if (t_ns) { *t_ns = util::monotonic_ns(); }
 
-        LOG_DBG("ch: %i, tx[1]: 0x%02x, r.value: 0x%03x %4i, r.norm: %5.1f", (int)channel, (int)(txBuffer[1]), (int)r.value(), (int)r.value(), r.norm());
+        if (cs != CS_batched)
+        {
+            for (size_t i = 0; (i < n) && !err; ++i) { err = transfer(txBuffer[i], rxBuffer[i]); }
+        }
+        else
+        {
+#ifndef RPIHAL_EMU
+
+            struct spi_ioc_transfer segments[channelCount];
+            std::memset(segments, 0, sizeof(segments));
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                segments[i].tx_buf = (uint64_t)(uintptr_t)txBuffer[i];
+                segments[i].rx_buf = (uint64_t)(uintptr_t)rxBuffer[i];
+                segments[i].len = 3;
+                segments[i].speed_hz = MAX_CLOCK_FREQ;
+                segments[i].bits_per_word = 8;
+                segments[i].cs_change = ((i + 1) < n ? 1 : 0); // deselect between the conversions
+            }
+
+            if (ioctl(spi->fd, SPI_IOC_MESSAGE(n), segments) < 0) { err = -(__LINE__); }
+
+#else  // RPIHAL_EMU
+
+            for (size_t i = 0; (i < n) && !err; ++i) { err = RPIHAL_SPI_transfer(spi, txBuffer[i], rxBuffer[i], 3); }
+
+#endif // RPIHAL_EMU
+        }
     }
 
-    return r;
+    if (err)
+    {
+        LOG_ERR("failed to scan channels 0x%02x, err: %i, errno: %i %s", (int)channels, err, errno, std::strerror(errno));
+        return -(__LINE__);
+    }
+
+    for (size_t i = 0; i < n; ++i) { results[map[i]] = parseRx(rxBuffer[i]); }
+
+    return 0;
+}
+
+
+
+void fillTx(uint8_t* txBuffer, uint8_t channel)
+{
+    txBuffer[0] = 0x01;                             // start bit
+    txBuffer[1] = (0x80 | ((channel & 0x03) << 4)); // single ended, channel
+    txBuffer[2] = 0;
+}
+
+uint16_t parseRx(const uint8_t* rxBuffer)
+{
+    uint16_t value = (uint16_t)(rxBuffer[1] & 0x03);
+    value <<= 8;
+    value |= (uint16_t)(rxBuffer[2]);
+
+    return value;
+}
+
+int transfer(const uint8_t* txBuffer, uint8_t* rxBuffer)
+{
+    int err;
+
+    if (cs == adc::CS_gpio)
+    {
+        RPIHAL_GPIO_writePin(PIN_nCS, 0);
+        err = RPIHAL_SPI_transfer(spi, txBuffer, rxBuffer, 3);
+        RPIHAL_GPIO_writePin(PIN_nCS, 1);
+    }
+    else { err = RPIHAL_SPI_transfer(spi, txBuffer, rxBuffer, 3); }
+
+    return err;
 }
 
 
@@ -8,40 +8,96 @@ copyright       MIT - Copyright (c) 2025 Oliver Blaser
 
 #include <cstddef>
 #include <cstdint>
+#include <type_traits>
 
 
 namespace adc {
 
+constexpr size_t channelCount = 4;
+
+constexpr uint16_t maxValue = 1023;
+
+// 2^21 + 2^11, the first two terms of 2^31 / maxValue = 2^21 * (1 + 2^-10 + 2^-20 + ...),
+// `(value * q15Factor + 0x8000) >> 16` is `value / maxValue` in Q15, rounded, for all 10 bit values
+constexpr uint32_t q15Factor = 2099200;
+
+/**
+ * @brief 10 bit conversion result.
+ *
+ * Only the raw value is stored, the normalised value is computed on demand. The class is trivially copyable and has
+ * the size of the raw value, so buffers of results can be copied with `memcpy()`. See `adc-convert.h` for the bulk
+ * conversion of buffers.
+ */
 class Result
 {
 public:
     Result()
-        : m_value(0), m_norm(0)
+        : m_value(0)
     {}
 
     Result(uint16_t value)
-        : m_value(value), m_norm((float)value / 1023.0f)
+        : m_value(value)
     {}
 
-    virtual ~Result() {}
-
     uint16_t value() const { return m_value; }
-    float norm() const { return m_norm; } // normalised value in range [0, 1]
+    float norm() const { return (float)m_value * (1.0f / (float)maxValue); } // normalised value in range [0, 1]
+    uint16_t normQ15() const { return (uint16_t)(((uint32_t)m_value * q15Factor + 0x8000) >> 16); } // normalised value in Q15, 1.0 is 32768
 
 private:
     uint16_t m_value;
-    float m_norm;
 };
 
-int init();
+static_assert(std::is_trivially_copyable<Result>::value, "adc::Result has to be trivially copyable");
+static_assert(sizeof(Result) == sizeof(uint16_t), "adc::Result has to be as big as the raw value");
+
+/**
+ * @brief Chip select strategies.
+ */
+enum CS
+{
+    CS_gpio = 0, // GPIO 8 is driven by the driver around each conversion, the bus is opened with `RPIHAL_SPI_CFG_NO_CS`
+    CS_kernel,   // CE0 is toggled by the kernel, one transfer per conversion
+    CS_batched,  // like `CS_kernel`, but `adc::scan()` does all conversions in one `SPI_IOC_MESSAGE` ioctl
+};
+
+/**
+ * @brief Opens the bus.
+ *
+ * The chip select strategy determines the flags of the bus (`spiBus::spi0Flags()`), so this has to be called before the
+ * other users of the bus are initialised. The kernel strategies need GPIO 8 to be CE0 (the default with
+ * `dtparam=spi=on`). `CS_gpio` configures it as output, `deinit()` resets it to its default and not to CE0.
+ *
+ * @param cs Chip select strategy (`adc::CS`)
+ * @return 0 on success
+ */
+int init(int cs = CS_batched);
 void deinit();
 
+int csMode();
+
 /**
  * @param channel ADC channel [0, 3]
+ * @param [out] result Not written on error
+ * @return 0 on success
+ */
+int read(uint8_t channel, Result& result);
+
+/**
+ * @brief Converts several channels in one SPI transfer.
+ *
+ * With `CS_batched` the conversions are segments of one `SPI_IOC_MESSAGE` ioctl, the kernel toggles nCS between
+ * them. So a scan costs one syscall instead of one per channel. The other strategies do one transfer per channel, all
+ * while holding the bus lock.
+ *
+ * @param channels Bit mask of the channels, bit 0 is channel 0
+ * @param results Destination indexed by the channel, has `adc::channelCount` elements. The elements of the channels
+ * which are not in the mask are not written.
+ * @param t_ns Start of the transfer (`util::monotonic_ns()`), may be `nullptr`
+ * @return 0 on success
  */
-Result read(uint8_t channel);
+int scan(uint8_t channels, Result* results, uint64_t* t_ns = nullptr);
 
-static inline Result readPoti() { return read(0); }
+static inline int readPoti(Result& result) { return read(0, result); }
 
 } // namespace adc
 
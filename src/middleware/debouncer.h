@@ -0,0 +1,118 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_DEBOUNCER_H
+#define IG_MIDDLEWARE_DEBOUNCER_H
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace util {
+
+/**
+ * @brief Debounces 64 inputs in parallel with vertical counters.
+ *
+ * Each input has a counter of `counterBits` bits. The counters are stored as bit planes, `m_cnt[k]` holds bit `k` of
+ * all counters, so one update is a fixed number of bitwise operations regardless of how many inputs are used. The
+ * counter of an input is incremented while its sample differs from the debounced state and cleared otherwise. Once the
+ * counter reaches the threshold of the input, the debounced state takes the sampled value.
+ */
+class Debouncer
+{
+public:
+    static constexpr size_t counterBits = 4;
+    static constexpr unsigned maxThreshold = (1u << counterBits) - 1;
+
+public:
+    Debouncer()
+        : m_state(0), m_cnt(), m_thr()
+    {
+        setThreshold(UINT64_MAX, 1);
+    }
+
+    virtual ~Debouncer() {}
+
+    /**
+     * @brief Sets the number of consecutive equal samples needed to change the state.
+     *
+     * @param inputs Bit mask of the inputs
+     * @param samples [1, `maxThreshold`], 1 disables the debouncing
+     */
+    void setThreshold(uint64_t inputs, unsigned samples)
+    {
+        if (samples < 1) { samples = 1; }
+        if (samples > maxThreshold) { samples = maxThreshold; }
+
+        for (size_t k = 0; k < counterBits; ++k)
+        {
+            if (samples & (1u << k)) { m_thr[k] |= inputs; }
+            else { m_thr[k] &= ~inputs; }
+        }
+    }
+
+    /**
+     * @brief Sets the state without debouncing and clears the counters.
+     */
+    void reset(uint64_t samples)
+    {
+        m_state = samples;
+        for (size_t k = 0; k < counterBits; ++k) { m_cnt[k] = 0; }
+    }
+
+    /**
+     * @brief Processes one sample of all inputs, has to be called periodically.
+     *
+     * @return The debounced state
+     */
+    uint64_t update(uint64_t samples)
+    {
+        const uint64_t delta = samples ^ m_state;
+
+        // increment the counters of the differing inputs (ripple carry through the planes), clear the others
+        uint64_t carry = delta;
+        for (size_t k = 0; k < counterBits; ++k)
+        {
+            const uint64_t c = m_cnt[k];
+            m_cnt[k] = (c ^ carry) & delta;
+            carry &= c;
+        }
+
+        uint64_t reached = delta;
+        for (size_t k = 0; k < counterBits; ++k) { reached &= ~(m_cnt[k] ^ m_thr[k]); }
+
+        m_state ^= reached;
+        for (size_t k = 0; k < counterBits; ++k) { m_cnt[k] &= ~reached; }
+
+        return m_state;
+    }
+
+    uint64_t state() const { return m_state; }
+
+    /**
+     * @brief Bit mask of the inputs whose sample differs from the debounced state.
+     */
+    uint64_t settling() const
+    {
+        uint64_t r = 0;
+        for (size_t k = 0; k < counterBits; ++k) { r |= m_cnt[k]; }
+        return r;
+    }
+
+private:
+    uint64_t m_state;
+    uint64_t m_cnt[counterBits];
+    uint64_t m_thr[counterBits];
+
+private:
+    Debouncer(const Debouncer& other) = delete;
+    Debouncer(const Debouncer&& other) = delete;
+    Debouncer& operator=(const Debouncer& other);
+};
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_DEBOUNCER_H
@@ -0,0 +1,164 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_ENCODER_H
+#define IG_MIDDLEWARE_ENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "middleware/seqlock.h"
+
+#include <rpihal/gpio.h>
+
+
+namespace gpio {
+
+/**
+ * @brief Decodes the signals of a quadrature encoder.
+ *
+ * The levels of both pins are taken from one bank read and form a 2 bit state (`A << 1 | B`). The previous and the
+ * current state index a 16 entry table which holds the step (-1, 0, +1). A transition in which both signals changed
+ * can't be decoded, it is counted as error and the position is not changed. This happens if the encoder is turned
+ * faster than it is sampled, or if a signal bounces.
+ *
+ * `update()` must only be called from one thread, `read()` can be called from any thread.
+ */
+class Encoder
+{
+public:
+    struct Snapshot
+    {
+        int64_t position; // quadrature steps, usually 4 per detent
+        uint32_t errors;  // illegal transitions
+        double velocity;  // steps per second, averaged over `velocityWindow_ns`
+        uint64_t t_ns;    // time of the last update (`util::monotonic_ns()`)
+    };
+
+    static constexpr uint64_t velocityWindow_ns = 20000000;
+
+public:
+    Encoder(int pinA, int pinB)
+        : m_pinA(pinA),
+          m_pinB(pinB),
+          m_state(0),
+          m_position(0),
+          m_errors(0),
+          m_windowPosition(0),
+          m_windowStart_ns(0),
+          m_velocity(0),
+          m_snapshot()
+    {}
+
+    virtual ~Encoder() {}
+
+    int pinA() const { return m_pinA; }
+    int pinB() const { return m_pinB; }
+    uint64_t pins() const { return (RPIHAL_GPIO_BIT(m_pinA) | RPIHAL_GPIO_BIT(m_pinB)); }
+
+    /**
+     * @brief Sets the state without decoding, and clears the position and the error count.
+     */
+    void reset(uint64_t levels, uint64_t t_ns)
+    {
+        m_state = state(levels);
+        m_position = 0;
+        m_errors = 0;
+        m_windowPosition = 0;
+        m_windowStart_ns = t_ns;
+        m_velocity = 0;
+
+        publish(t_ns);
+    }
+
+    /**
+     * @brief Processes one sample, has to be called with every sample, also if the pins did not change.
+     *
+     * @param levels Raw pin levels (`RPIHAL_GPIO_read64()`)
+     * @param t_ns Sample time (`util::monotonic_ns()`)
+     */
+    void update(uint64_t levels, uint64_t t_ns)
+    {
+        const unsigned s = state(levels);
+        const unsigned idx = (m_state << 2) | s;
+        const int step = steps[idx];
+        const uint32_t error = (illegal >> idx) & 1;
+
+        m_state = s;
+        m_position += step;
+        m_errors += error;
+
+        bool changed = ((step != 0) || (error != 0));
+
+        if ((t_ns - m_windowStart_ns) >= velocityWindow_ns)
+        {
+            const double velocity = (double)(m_position - m_windowPosition) * 1e9 / (double)(t_ns - m_windowStart_ns);
+
+            if (velocity != m_velocity) { changed = true; }
+
+            m_velocity = velocity;
+            m_windowPosition = m_position;
+            m_windowStart_ns = t_ns;
+        }
+
+        if (changed) { publish(t_ns); }
+    }
+
+    /**
+     * @return `false` if the encoder has not yet been reset
+     */
+    bool read(Snapshot& snapshot) const { return (m_snapshot.read(snapshot) != 0); }
+
+    int64_t position() const
+    {
+        Snapshot snapshot;
+        return (read(snapshot) ? snapshot.position : 0);
+    }
+
+private:
+    // index: previous state << 2 | current state, the sequence 0 1 3 2 counts up
+    static constexpr int8_t steps[16] = {
+        0, +1, -1, 0, //
+        -1, 0, 0, +1, //
+        +1, 0, 0, -1, //
+        0, -1, +1, 0, //
+    };
+
+    // the transitions 0-3, 1-2, 2-1 and 3-0 (both signals changed)
+    static constexpr uint16_t illegal = (1u << 3) | (1u << 6) | (1u << 9) | (1u << 12);
+
+    int m_pinA;
+    int m_pinB;
+    unsigned m_state;
+    int64_t m_position;
+    uint32_t m_errors;
+    int64_t m_windowPosition;
+    uint64_t m_windowStart_ns;
+    double m_velocity;
+    util::Seqlock<Snapshot> m_snapshot;
+
+    unsigned state(uint64_t levels) const { return (unsigned)((((levels >> m_pinA) & 1) << 1) | ((levels >> m_pinB) & 1)); }
+
+    void publish(uint64_t t_ns)
+    {
+        Snapshot snapshot;
+        snapshot.position = m_position;
+        snapshot.errors = m_errors;
+        snapshot.velocity = m_velocity;
+        snapshot.t_ns = t_ns;
+
+        m_snapshot.write(snapshot);
+    }
+
+private:
+    Encoder(const Encoder& other) = delete;
+    Encoder(const Encoder&& other) = delete;
+    Encoder& operator=(const Encoder& other);
+};
+
+} // namespace gpio
+
+
+#endif // IG_MIDDLEWARE_ENCODER_H
@@ -0,0 +1,233 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "event-loop.h"
+
+#include <omw/clock.h>
+#include <omw/defs.h>
+
+#ifdef __linux__
+#define EVENTLOOP_EPOLL (1)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#endif
+
+
+#define LOG_MODULE_LEVEL LOG_LEVEL_INF
+#define LOG_MODULE_NAME  EVLOOP
+#include "middleware/log.h"
+
+
+using omw::clock::timepoint_t;
+
+
+
+#if EVENTLOOP_EPOLL
+
+static int epfd = -1;
+static int timerfd = -1;
+static int wakeupfd = -1;
+
+static int addReadFd(int fd);
+static void drain(int fd);
+
+#else // EVENTLOOP_EPOLL
+
+static std::mutex mtx;
+static std::condition_variable cv;
+static bool wakeupFlag = false;
+
+#endif // EVENTLOOP_EPOLL
+
+
+
+int eventLoop::init()
+{
+#if EVENTLOOP_EPOLL
+
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0)
+    {
+        LOG_ERR("epoll_create1() failed, errno: %i %s", errno, std::strerror(errno));
+        return -(__LINE__);
+    }
+
+    timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timerfd < 0)
+    {
+        LOG_ERR("timerfd_create() failed, errno: %i %s", errno, std::strerror(errno));
+        return -(__LINE__);
+    }
+
+    wakeupfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeupfd < 0)
+    {
+        LOG_ERR("eventfd() failed, errno: %i %s", errno, std::strerror(errno));
+        return -(__LINE__);
+    }
+
+    if (addReadFd(timerfd) || addReadFd(wakeupfd)) { return -(__LINE__); }
+
+#else // EVENTLOOP_EPOLL
+
+    std::lock_guard<std::mutex> lg(mtx);
+    wakeupFlag = false;
+
+#endif // EVENTLOOP_EPOLL
+
+    return 0;
+}
+
+void eventLoop::deinit()
+{
+#if EVENTLOOP_EPOLL
+    if (wakeupfd >= 0) { close(wakeupfd); }
+    if (timerfd >= 0) { close(timerfd); }
+    if (epfd >= 0) { close(epfd); }
+
+    wakeupfd = -1;
+    timerfd = -1;
+    epfd = -1;
+#endif // EVENTLOOP_EPOLL
+}
+
+int eventLoop::addFd(int fd)
+{
+#if EVENTLOOP_EPOLL
+    return addReadFd(fd);
+#else
+    LOG_ERR("%s is not supported on this platform", __func__);
+    return -(__LINE__);
+#endif
+}
+
+void eventLoop::removeFd(int fd)
+{
+#if EVENTLOOP_EPOLL
+    if ((epfd >= 0) && (epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr) != 0))
+    {
+        LOG_ERR("failed to remove fd %i, errno: %i %s", fd, errno, std::strerror(errno));
+    }
+#endif
+}
+
+int eventLoop::wait(timepoint_t deadline)
+{
+    const timepoint_t timeout_us = deadline - omw::clock::now();
+
+    if (timeout_us <= 0) { return 0; }
+
+#if EVENTLOOP_EPOLL
+
+    struct itimerspec its;
+    std::memset(&its, 0, sizeof(its));
+
+    if (deadline != noDeadline)
+    {
+        its.it_value.tv_sec = (time_t)(timeout_us / omw::clock::second_us);
+        its.it_value.tv_nsec = (long)((timeout_us % omw::clock::second_us) * 1000);
+    }
+
+    // a zero it_value disarms the timer
+    if (timerfd_settime(timerfd, 0, &its, nullptr) != 0)
+    {
+        LOG_ERR("timerfd_settime() failed, errno: %i %s", errno, std::strerror(errno));
+        return -(__LINE__);
+    }
+
+    constexpr int maxEvents = 8;
+    struct epoll_event events[maxEvents];
+
+    const int n = epoll_wait(epfd, events, maxEvents, -1);
+
+    if (n < 0)
+    {
+        if (errno == EINTR) { return 0; }
+
+        LOG_ERR("epoll_wait() failed, errno: %i %s", errno, std::strerror(errno));
+        return -(__LINE__);
+    }
+
+    // only the own descriptors are drained, the others are owned by the module which added them
+    for (int i = 0; i < n; ++i)
+    {
+        const int fd = events[i].data.fd;
+        if ((fd == timerfd) || (fd == wakeupfd)) { drain(fd); }
+    }
+
+#else // EVENTLOOP_EPOLL
+
+    std::unique_lock<std::mutex> lock(mtx);
+
+    if (deadline == noDeadline) { cv.wait(lock, [] { return wakeupFlag; }); }
+    else { cv.wait_for(lock, std::chrono::microseconds(timeout_us), [] { return wakeupFlag; }); }
+
+    wakeupFlag = false;
+
+#endif // EVENTLOOP_EPOLL
+
+    return 0;
+}
+
+void eventLoop::wakeup()
+{
+#if EVENTLOOP_EPOLL
+
+    const uint64_t value = 1;
+    if (write(wakeupfd, &value, sizeof(value)) != (ssize_t)sizeof(value))
+    {
+        // EAGAIN means the counter is saturated, so the loop will wake up anyway
+        if (errno != EAGAIN) { LOG_ERR("failed to signal eventfd, errno: %i %s", errno, std::strerror(errno)); }
+    }
+
+#else // EVENTLOOP_EPOLL
+
+    {
+        std::lock_guard<std::mutex> lg(mtx);
+        wakeupFlag = true;
+    }
+    cv.notify_one();
+
+#endif // EVENTLOOP_EPOLL
+}
+
+
+
+#if EVENTLOOP_EPOLL
+
+int addReadFd(int fd)
+{
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) != 0)
+    {
+        LOG_ERR("failed to add fd %i, errno: %i %s", fd, errno, std::strerror(errno));
+        return -(__LINE__);
+    }
+
+    return 0;
+}
+
+void drain(int fd)
+{
+    uint64_t value;
+    while (read(fd, &value, sizeof(value)) == (ssize_t)sizeof(value)) {}
+}
+
+#endif // EVENTLOOP_EPOLL
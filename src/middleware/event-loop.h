@@ -0,0 +1,62 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_EVENTLOOP_H
+#define IG_MIDDLEWARE_EVENTLOOP_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <omw/clock.h>
+
+
+namespace eventLoop {
+
+constexpr omw::clock::timepoint_t noDeadline = INT64_MAX;
+
+/**
+ * @brief Initialises the wakeup sources of the main loop.
+ *
+ * On Linux the loop is built on epoll, a timerfd for the deadline and an eventfd for `wakeup()`. On other platforms
+ * (emulator on Windows) a condition variable is used.
+ *
+ * @return 0 on success
+ */
+int init();
+
+void deinit();
+
+/**
+ * @brief Adds a file descriptor to the set of wakeup sources.
+ *
+ * The event loop does not read from the descriptor, the owner has to drain it, otherwise `wait()` returns immediately.
+ * Only available on Linux.
+ *
+ * @param fd File descriptor which becomes readable on an event
+ * @return 0 on success
+ */
+int addFd(int fd);
+
+void removeFd(int fd);
+
+/**
+ * @brief Blocks until a wakeup source is signaled or the deadline is reached.
+ *
+ * Returns immediately if the deadline already has passed.
+ *
+ * @param deadline Absolute `omw::clock` timepoint, `eventLoop::noDeadline` to wait for events only
+ * @return 0 on success
+ */
+int wait(omw::clock::timepoint_t deadline);
+
+/**
+ * @brief Wakes up the main loop, can be called from any thread.
+ */
+void wakeup();
+
+} // namespace eventLoop
+
+
+#endif // IG_MIDDLEWARE_EVENTLOOP_H
@@ -0,0 +1,166 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+#include "event-loop.h"
+#include "gesture.h"
+
+
+#define LOG_MODULE_LEVEL LOG_LEVEL_INF
+#define LOG_MODULE_NAME  GESTURE
+#include "middleware/log.h"
+
+
+using timepoint_t = gesture::Recognizer::timepoint_t;
+
+
+
+gesture::Recognizer::Recognizer()
+    : m_buttons(), m_nButtons(0), m_queue(), m_overrunCnt(0)
+{}
+
+int gesture::Recognizer::add(const Timing& timing)
+{
+    if (m_nButtons >= maxButtons)
+    {
+        LOG_ERR("too many buttons");
+        return -(__LINE__);
+    }
+
+    if ((timing.doubleClick_us < 0) || (timing.longPress_us <= 0) || (timing.repeat_us < 0))
+    {
+        LOG_ERR("invalid timing");
+        return -(__LINE__);
+    }
+
+    const int id = (int)m_nButtons;
+    ++m_nButtons;
+
+    Button& b = m_buttons[id];
+    b.timing = timing;
+    b.state = S_idle;
+    b.clickPending = false;
+    b.repeatCnt = 0;
+    b.deadline = eventLoop::noDeadline;
+
+    return id;
+}
+
+void gesture::Recognizer::edge(int button, bool pressed, timepoint_t tp)
+{
+    if ((button < 0) || ((size_t)button >= m_nButtons)) { return; }
+
+    Button& b = m_buttons[button];
+
+    if (pressed)
+    {
+        // a second press keeps the pending click
+        if ((b.state == S_idle) || (b.state == S_released))
+        {
+            b.state = S_pressed;
+            b.deadline = tp + b.timing.longPress_us;
+        }
+    }
+    else if (b.state == S_pressed)
+    {
+        if (b.clickPending)
+        {
+            m_emit(button, E_doubleClick, tp);
+            b.clickPending = false;
+            b.state = S_idle;
+            b.deadline = eventLoop::noDeadline;
+        }
+        else if (b.timing.doubleClick_us > 0)
+        {
+            b.clickPending = true;
+            b.state = S_released;
+            b.deadline = tp + b.timing.doubleClick_us;
+        }
+        else
+        {
+            m_emit(button, E_click, tp);
+            b.state = S_idle;
+            b.deadline = eventLoop::noDeadline;
+        }
+    }
+    else if (b.state == S_held)
+    {
+        b.state = S_idle;
+        b.deadline = eventLoop::noDeadline;
+    }
+}
+
+void gesture::Recognizer::poll(timepoint_t tpNow)
+{
+    for (size_t i = 0; i < m_nButtons; ++i)
+    {
+        Button& b = m_buttons[i];
+        const int button = (int)i;
+
+        if (b.deadline > tpNow) { continue; }
+
+        switch (b.state)
+        {
+        case S_pressed:
+            // click followed by a long press
+            if (b.clickPending)
+            {
+                m_emit(button, E_click, b.deadline);
+                b.clickPending = false;
+            }
+
+            m_emit(button, E_longPress, b.deadline);
+            b.repeatCnt = 0;
+            b.state = S_held;
+            b.deadline = ((b.timing.repeat_us > 0) ? (b.deadline + b.timing.repeat_us) : eventLoop::noDeadline);
+            break;
+
+        case S_held:
+            ++b.repeatCnt;
+            m_emit(button, E_repeat, b.deadline, b.repeatCnt);
+
+            // missed repeats are skipped instead of being emitted in a burst
+            b.deadline += b.timing.repeat_us;
+            if (b.deadline <= tpNow) { b.deadline = tpNow + b.timing.repeat_us; }
+            break;
+
+        case S_released:
+            m_emit(button, E_click, b.deadline);
+            b.clickPending = false;
+            b.state = S_idle;
+            b.deadline = eventLoop::noDeadline;
+            break;
+
+        default:
+            b.deadline = eventLoop::noDeadline;
+            break;
+        }
+    }
+}
+
+timepoint_t gesture::Recognizer::deadline() const
+{
+    timepoint_t tp = eventLoop::noDeadline;
+
+    for (size_t i = 0; i < m_nButtons; ++i)
+    {
+        if (m_buttons[i].deadline < tp) { tp = m_buttons[i].deadline; }
+    }
+
+    return tp;
+}
+
+void gesture::Recognizer::m_emit(int button, int type, timepoint_t tp, uint32_t count)
+{
+    Event event;
+    event.tp = tp;
+    event.button = button;
+    event.type = type;
+    event.count = count;
+
+    if (!m_queue.push(event)) { ++m_overrunCnt; }
+}
@@ -0,0 +1,141 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_GESTURE_H
+#define IG_MIDDLEWARE_GESTURE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "middleware/spsc-queue.h"
+
+#include <omw/clock.h>
+
+
+namespace gesture {
+
+enum EVENT
+{
+    E_click = 0,
+    E_doubleClick,
+    E_longPress,
+    E_repeat, // while the button is held after a long press
+};
+
+struct Event
+{
+    omw::clock::timepoint_t tp; // time at which the gesture was recognised
+    int button;
+    int type;       // `gesture::EVENT`
+    uint32_t count; // number of the repeat event, starting at 1
+};
+
+struct Timing
+{
+    omw::clock::timepoint_t doubleClick_us; // max time between the release and the second press, 0 to disable double clicks
+    omw::clock::timepoint_t longPress_us;   // min press duration of a long press
+    omw::clock::timepoint_t repeat_us;      // repeat interval after the long press, 0 to disable repeating
+};
+
+static inline Timing defaultTiming()
+{
+    Timing t;
+    t.doubleClick_us = 250 * 1000;
+    t.longPress_us = 1000 * 1000;
+    t.repeat_us = 0;
+    return t;
+}
+
+/**
+ * @brief Recognises click, double click, long press and repeat gestures of buttons.
+ *
+ * The recognizer is driven by timestamped edges, each edge and each elapsed timer is a constant number of operations.
+ * The timers don't have to be checked every loop pass, `poll()` only needs to be called at `deadline()`. The recognised
+ * gestures are put into a fixed capacity queue. All functions have to be called from the same thread.
+ */
+class Recognizer
+{
+public:
+    using timepoint_t = omw::clock::timepoint_t;
+
+    static constexpr size_t maxButtons = 4;
+    static constexpr size_t queueSize = 16;
+
+public:
+    Recognizer();
+
+    virtual ~Recognizer() {}
+
+    /**
+     * @brief Adds a button.
+     *
+     * @return Button ID on success, negative on error
+     */
+    int add(const Timing& timing);
+
+    /**
+     * @brief Processes an edge of the debounced button state.
+     *
+     * @param button Button ID
+     * @param pressed New state
+     * @param tp Time of the edge (e.g. `gpio::changeTime()`)
+     */
+    void edge(int button, bool pressed, timepoint_t tp);
+
+    /**
+     * @brief Emits the gestures whose timer has elapsed.
+     */
+    void poll(timepoint_t tpNow);
+
+    /**
+     * @return Time at which `poll()` has to be called, `eventLoop::noDeadline` if no timer is running
+     */
+    timepoint_t deadline() const;
+
+    /**
+     * @return `false` if no event is pending
+     */
+    bool pop(Event& event) { return m_queue.pop(event); }
+
+    /**
+     * @return Number of events dropped because the queue was full
+     */
+    uint32_t overruns() const { return m_overrunCnt; }
+
+private:
+    enum STATE
+    {
+        S_idle = 0,
+        S_pressed,    // waiting for the release or the long press
+        S_released,   // a click waits for the second press
+        S_held,       // long press recognised, waiting for the release
+    };
+
+    struct Button
+    {
+        Timing timing;
+        int state;
+        bool clickPending; // the first click of a possible double click
+        uint32_t repeatCnt;
+        timepoint_t deadline; // `eventLoop::noDeadline` if no timer is running
+    };
+
+    Button m_buttons[maxButtons];
+    size_t m_nButtons;
+    util::SpscQueue<Event, queueSize> m_queue;
+    uint32_t m_overrunCnt;
+
+    void m_emit(int button, int type, timepoint_t tp, uint32_t count = 0);
+
+private:
+    Recognizer(const Recognizer& other) = delete;
+    Recognizer(const Recognizer&& other) = delete;
+    Recognizer& operator=(const Recognizer& other);
+};
+
+} // namespace gesture
+
+
+#endif // IG_MIDDLEWARE_GESTURE_H
@@ -0,0 +1,286 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include "event-loop.h"
+#include "gpio-event.h"
+#include "middleware/spsc-queue.h"
+#include "middleware/util.h"
+#include "project.h"
+
+#include <rpihal/gpio.h>
+
+#ifdef RPIHAL_EMU
+#include <rpihal/emu/emu.h>
+#else // RPIHAL_EMU
+#include <fcntl.h>
+#include <linux/gpio.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif // RPIHAL_EMU
+
+
+#define LOG_MODULE_LEVEL LOG_LEVEL_INF
+#define LOG_MODULE_NAME  GPIOEVT
+#include "middleware/log.h"
+
+
+#define WATCHER_PERIOD_MS (2)
+
+
+
+// filled by the thread which reads the line fd (main loop) or by the watcher thread, never by both
+static util::SpscQueue<gpioEvent::Edge, 256> edges;
+static std::atomic<uint64_t> capturePins(0);
+static std::atomic<uint32_t> lostCnt(0);
+
+static std::thread watcher;
+static std::atomic<bool> watcherRun(false);
+
+static void pushEdge(uint64_t t_ns, int pin, bool rising);
+static void watcherThread(uint64_t pins);
+
+#ifndef RPIHAL_EMU
+static int linefd = -1;
+static uint32_t lastSeqno = 0;
+
+static int openChip();
+#endif // RPIHAL_EMU
+
+
+
+int gpioEvent::init(uint64_t pins)
+{
+    if (pins == 0) { return 0; }
+
+#ifndef RPIHAL_EMU
+    linefd = requestLines(pins, true, true, 256);
+    lastSeqno = 0;
+
+    if (linefd >= 0)
+    {
+        if (eventLoop::addFd(linefd) == 0) { return 0; }
+
+        close(linefd);
+        linefd = -1;
+    }
+
+    LOG_WRN("GPIO character device is not available, falling back to sampling the inputs every %ims", WATCHER_PERIOD_MS);
+#endif // RPIHAL_EMU
+
+    watcherRun = true;
+    watcher = std::thread(watcherThread, pins);
+
+    return 0;
+}
+
+void gpioEvent::deinit()
+{
+    watcherRun = false;
+    if (watcher.joinable()) { watcher.join(); }
+
+#ifndef RPIHAL_EMU
+    if (linefd >= 0)
+    {
+        eventLoop::removeFd(linefd);
+        close(linefd);
+        linefd = -1;
+    }
+#endif // RPIHAL_EMU
+}
+
+void gpioEvent::handler()
+{
+#ifndef RPIHAL_EMU
+    if (linefd >= 0)
+    {
+        constexpr size_t n = 16;
+        struct gpio_v2_line_event events[n];
+        ssize_t nBytes;
+
+        while ((nBytes = read(linefd, events, sizeof(events))) > 0)
+        {
+            const size_t cnt = (size_t)nBytes / sizeof(events[0]);
+
+            for (size_t i = 0; i < cnt; ++i)
+            {
+                const struct gpio_v2_line_event& ev = events[i];
+
+                // the sequence number of the request has gaps if the kernel buffer overflowed
+                if ((lastSeqno != 0) && ((ev.seqno - lastSeqno) > 1)) { lostCnt += (ev.seqno - lastSeqno - 1); }
+                lastSeqno = ev.seqno;
+
+                pushEdge(ev.timestamp_ns, (int)ev.offset, (ev.id == GPIO_V2_LINE_EVENT_RISING_EDGE));
+            }
+        }
+    }
+#endif // RPIHAL_EMU
+}
+
+void gpioEvent::capture(uint64_t pins) { capturePins = pins; }
+
+size_t gpioEvent::drain(Edge* buffer, size_t count)
+{
+    size_t n = 0;
+    while ((n < count) && edges.pop(buffer[n])) { ++n; }
+    return n;
+}
+
+uint32_t gpioEvent::lost() { return lostCnt; }
+
+bool gpioEvent::kernelTimestamps()
+{
+#ifndef RPIHAL_EMU
+    return (linefd >= 0);
+#else
+    return false;
+#endif
+}
+
+int gpioEvent::requestLines(uint64_t pins, bool rising, bool falling, uint32_t bufferSize)
+{
+#ifndef RPIHAL_EMU
+
+    const int chipfd = openChip();
+    if (chipfd < 0) { return -1; }
+
+    struct gpio_v2_line_request req;
+    std::memset(&req, 0, sizeof(req));
+
+    for (int pin = 0; (pin < 64) && (req.num_lines < GPIO_V2_LINES_MAX); ++pin)
+    {
+        if (pins & RPIHAL_GPIO_BIT(pin))
+        {
+            req.offsets[req.num_lines] = (uint32_t)pin;
+            ++req.num_lines;
+        }
+    }
+
+    std::strncpy(req.consumer, prj::binName, sizeof(req.consumer) - 1);
+    req.event_buffer_size = bufferSize;
+
+    // the timestamps are CLOCK_MONOTONIC by default, the same clock as `util::monotonic_ns()`
+    req.config.flags = GPIO_V2_LINE_FLAG_INPUT;
+    if (rising) { req.config.flags |= GPIO_V2_LINE_FLAG_EDGE_RISING; }
+    if (falling) { req.config.flags |= GPIO_V2_LINE_FLAG_EDGE_FALLING; }
+
+    const int ioctlRes = ioctl(chipfd, GPIO_V2_GET_LINE_IOCTL, &req);
+    const int ioctlErrno = errno;
+    close(chipfd);
+
+    if (ioctlRes != 0)
+    {
+        LOG_ERR("GPIO_V2_GET_LINE_IOCTL failed, errno: %i %s", ioctlErrno, std::strerror(ioctlErrno));
+        return -1;
+    }
+
+    const int flags = fcntl(req.fd, F_GETFL);
+    if ((flags < 0) || (fcntl(req.fd, F_SETFL, flags | O_NONBLOCK) != 0))
+    {
+        LOG_ERR("failed to set line fd non blocking, errno: %i %s", errno, std::strerror(errno));
+        close(req.fd);
+        return -1;
+    }
+
+    return req.fd;
+
+#else  // RPIHAL_EMU
+    return -1;
+#endif // RPIHAL_EMU
+}
+
+
+
+void pushEdge(uint64_t t_ns, int pin, bool rising)
+{
+    if ((capturePins.load(std::memory_order_relaxed) & RPIHAL_GPIO_BIT(pin)) == 0) { return; }
+
+    gpioEvent::Edge edge;
+    edge.t_ns = t_ns;
+    edge.pin = (uint8_t)pin;
+    edge.rising = rising;
+
+    if (!edges.push(edge)) { ++lostCnt; }
+}
+
+
+
+void watcherThread(uint64_t pins)
+{
+    uint64_t old = RPIHAL_GPIO_read64() & pins;
+
+    while (watcherRun)
+    {
+        util::sleep(WATCHER_PERIOD_MS);
+
+        const uint64_t value = RPIHAL_GPIO_read64() & pins;
+
+        if (value != old)
+        {
+            const uint64_t t_ns = util::monotonic_ns();
+            const uint64_t changed = value ^ old;
+
+            for (int pin = 0; pin < 64; ++pin)
+            {
+                if (changed & RPIHAL_GPIO_BIT(pin)) { pushEdge(t_ns, pin, ((value & RPIHAL_GPIO_BIT(pin)) != 0)); }
+            }
+
+            old = value;
+            eventLoop::wakeup();
+        }
+
+#ifdef RPIHAL_EMU
+        // let the main loop see that the emulator has been closed
+        if (!RPIHAL_EMU_isRunning())
+        {
+            eventLoop::wakeup();
+            break;
+        }
+#endif
+    }
+}
+
+
+
+#ifndef RPIHAL_EMU
+
+/**
+ * @brief Opens the GPIO chip which provides the 40 pin header.
+ *
+ * The chip number differs between models and kernel versions, the pin controller is identified by its label.
+ */
+int openChip()
+{
+    for (int i = 0; i < 16; ++i)
+    {
+        char path[32];
+        std::snprintf(path, sizeof(path), "/dev/gpiochip%i", i);
+
+        const int fd = open(path, O_RDWR | O_CLOEXEC);
+        if (fd < 0) { continue; }
+
+        struct gpiochip_info info;
+        std::memset(&info, 0, sizeof(info));
+
+        if ((ioctl(fd, GPIO_GET_CHIPINFO_IOCTL, &info) == 0) && (std::strncmp(info.label, "pinctrl-", 8) == 0) && (info.lines >= 28))
+        {
+            LOG_DBG("using %s (%s, %u lines)", path, info.label, info.lines);
+            return fd;
+        }
+
+        close(fd);
+    }
+
+    return -1;
+}
+
+#endif // RPIHAL_EMU
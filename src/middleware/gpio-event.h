@@ -0,0 +1,90 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_GPIOEVENT_H
+#define IG_MIDDLEWARE_GPIOEVENT_H
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace gpioEvent {
+
+struct Edge
+{
+    uint64_t t_ns; // time of the edge (`util::monotonic_ns()`)
+    uint8_t pin;
+    bool rising; // pin level, not the logical state of the input
+};
+
+/**
+ * @brief Registers the input pins as wakeup source of the event loop.
+ *
+ * On the Pi the lines are requested with edge detection from the GPIO character device. In the emulator, or if the
+ * character device is not available, a watcher thread samples the pins and wakes up the event loop on a change.
+ *
+ * `eventLoop::init()` has to be called before.
+ *
+ * @param pins Bit mask of the pins (`RPIHAL_GPIO_BIT()`)
+ * @return 0 on success
+ */
+int init(uint64_t pins);
+
+void deinit();
+
+/**
+ * @brief Consumes the pending edge events, has to be called after each wakeup of the event loop.
+ */
+void handler();
+
+/**
+ * @brief Selects the pins whose edges are captured.
+ *
+ * The edges of the captured pins are collected into a ring, which the application drains with `gpioEvent::drain()`.
+ * With the GPIO character device the timestamps are taken by the kernel in the interrupt (`CLOCK_MONOTONIC`). The
+ * stand-in (emulator, or if the character device is not available) timestamps the edges when it samples the pins, so
+ * their resolution is the sampling period.
+ *
+ * @param pins Bit mask of the pins (`RPIHAL_GPIO_BIT()`), has to be a subset of the pins passed to `gpioEvent::init()`
+ */
+void capture(uint64_t pins);
+
+/**
+ * @brief Pops the captured edges, oldest first. Must only be called from the main loop thread.
+ *
+ * @param edges Destination
+ * @param count Capacity of `edges`
+ * @return Number of edges written to `edges`
+ */
+size_t drain(Edge* edges, size_t count);
+
+/**
+ * @return Number of captured edges lost because the ring or the kernel buffer was full
+ */
+uint32_t lost();
+
+/**
+ * @return `true` if the edges are timestamped by the kernel
+ */
+bool kernelTimestamps();
+
+/**
+ * @brief Requests input lines with edge detection from the GPIO character device.
+ *
+ * The events are read from the returned descriptor as `struct gpio_v2_line_event`, which is non blocking. Not available
+ * in the emulator.
+ *
+ * @param pins Bit mask of the pins (`RPIHAL_GPIO_BIT()`)
+ * @param rising Detect rising edges
+ * @param falling Detect falling edges
+ * @param bufferSize Size of the kernel event buffer (number of events), 0 for the default of the kernel
+ * @return File descriptor of the lines, -1 on error
+ */
+int requestLines(uint64_t pins, bool rising, bool falling, uint32_t bufferSize);
+
+} // namespace gpioEvent
+
+
+#endif // IG_MIDDLEWARE_GPIOEVENT_H
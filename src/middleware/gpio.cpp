@@ -6,7 +6,15 @@ copyright       MIT - Copyright (c) 2024 Oliver Blaser
 #include <cstddef>
 #include <cstdint>
 
+#include "event-loop.h"
+#include "gpio-event.h"
 #include "gpio.h"
+#include "middleware/input-sampler.h"
+#include "middleware/pulse.h"
+#include "middleware/pwm.h"
+#include "middleware/util.h"
+
+#include <omw/clock.h>
 
 #include <rpihal/gpio.h>
 
@@ -16,6 +24,29 @@ copyright       MIT - Copyright (c) 2024 Oliver Blaser
 #include "middleware/log.h"
 
 
+static uint64_t sampledLevels = 0;
+static omw::clock::timepoint_t tpSample = 0;
+static omw::clock::timepoint_t tpNextDebounce = 0;
+
+// captured edges
+static uint64_t edgePending = 0;  // pins with an edge which has not yet been reported by the input bank
+static uint64_t firstEdge_ns[64]; // first edge of the pending change
+static omw::clock::timepoint_t tpChange[64];
+
+static gpio::Encoder* encoders[4];
+static size_t encoderCnt = 0;
+
+// without real-time sampling the encoders are decoded from the edges of the character device, in the kernel's order
+static bool encoderEdges = false;
+static uint64_t encoderLevels = 0; // levels of the encoder pins, updated by each edge
+static uint32_t encoderLost = 0;
+
+static void drainEdges();
+static void updateChangeTimes(omw::clock::timepoint_t tpNow, bool sampled);
+static uint64_t encoderPins();
+static int startEvents();
+
+
 int gpio::init()
 {
     int r = RPIHAL_GPIO_init();
@@ -32,6 +63,13 @@ int gpio::init()
         if (RPIHAL_GPIO_initPin(GPIO_BTN0, &initStruct)) { r = -(__LINE__); }
         if (RPIHAL_GPIO_initPin(GPIO_BTN1, &initStruct)) { r = -(__LINE__); }
 
+        initStruct.pull = RPIHAL_GPIO_PULL_UP;
+        for (size_t i = 0; i < encoderCnt; ++i)
+        {
+            if (RPIHAL_GPIO_initPin(encoders[i]->pinA(), &initStruct)) { r = -(__LINE__); }
+            if (RPIHAL_GPIO_initPin(encoders[i]->pinB(), &initStruct)) { r = -(__LINE__); }
+        }
+
 
 
         initStruct.mode = RPIHAL_GPIO_MODE_OUT;
@@ -42,6 +80,22 @@ int gpio::init()
 
 
         if (r) { LOG_ERR("RPIHAL_GPIO_initPin() failed at line %i", -r); }
+
+        if (r == 0) { outputs().sync(); }
+
+
+
+        // the inputs start without edges
+        if (r == 0)
+        {
+            const uint64_t levels = RPIHAL_GPIO_read64();
+            const uint64_t t_ns = util::monotonic_ns();
+
+            inputs().reset(levels);
+            for (size_t i = 0; i < encoderCnt; ++i) { encoders[i]->reset(levels, t_ns); }
+        }
+
+        if ((r == 0) && startEvents()) { r = -(__LINE__); }
     }
     else { LOG_ERR("RPIHAL_GPIO_init() failed %i", r); }
 
@@ -52,9 +106,20 @@ void gpio::deinit()
 {
     int r = 0;
 
+    inputSampler::stop();
+    pulse::stop();
+    pwm::stop();
+    gpioEvent::deinit();
+
     if (RPIHAL_GPIO_resetPin(GPIO_BTN0)) { r = -(__LINE__); }
     if (RPIHAL_GPIO_resetPin(GPIO_BTN1)) { r = -(__LINE__); }
 
+    for (size_t i = 0; i < encoderCnt; ++i)
+    {
+        if (RPIHAL_GPIO_resetPin(encoders[i]->pinA())) { r = -(__LINE__); }
+        if (RPIHAL_GPIO_resetPin(encoders[i]->pinB())) { r = -(__LINE__); }
+    }
+
     if (RPIHAL_GPIO_resetPin(GPIO_LED0)) { r = -(__LINE__); }
     if (RPIHAL_GPIO_resetPin(GPIO_LED1)) { r = -(__LINE__); }
 
@@ -63,8 +128,120 @@ void gpio::deinit()
 
 void gpio::task()
 {
-    btn0->handler();
-    btn1->handler();
+    gpioEvent::handler();
+
+    const omw::clock::timepoint_t tpNow = omw::clock::now();
+    uint64_t levels;
+
+    if (inputSampler::running())
+    {
+        // one event per pass, so that the application sees every edge
+        inputSampler::Event event;
+        if (inputSampler::pop(event))
+        {
+            sampledLevels = event.levels;
+            tpSample = tpNow - (omw::clock::timepoint_t)((util::monotonic_ns() - event.t_ns) / 1000);
+
+            if (inputSampler::pending()) { eventLoop::wakeup(); }
+        }
+        else { tpSample = tpNow; }
+
+        levels = sampledLevels;
+    }
+    else
+    {
+        tpSample = tpNow;
+        levels = RPIHAL_GPIO_read64();
+
+        // the stand-in of the character device samples the pins, both encoder signals may change in one sample
+        if (!encoderEdges)
+        {
+            const uint64_t t_ns = util::monotonic_ns();
+            for (size_t i = 0; i < encoderCnt; ++i) { encoders[i]->update(levels, t_ns); }
+        }
+    }
+
+    drainEdges();
+
+    // a change is sampled immediately, the following samples of the settling pins are taken at the debounce interval
+    const bool sampled = (!inputs().settling() || (tpNow >= tpNextDebounce));
+
+    if (sampled)
+    {
+        inputs().update(levels);
+        tpNextDebounce = tpNow + debounceInterval_us;
+    }
+    else { inputs().clearEdges(); }
+
+    updateChangeTimes(tpNow, sampled);
+}
+
+omw::clock::timepoint_t gpio::deadline() { return (inputs().settling() ? tpNextDebounce : eventLoop::noDeadline); }
+
+int gpio::startRtSampling(const inputSampler::Config& cfg)
+{
+    // the sampler wakes up the event loop itself
+    gpioEvent::deinit();
+    encoderEdges = false;
+
+    sampledLevels = RPIHAL_GPIO_read64() & inputs().pins();
+
+    for (size_t i = 0; i < encoderCnt; ++i)
+    {
+        if (inputSampler::attach(*encoders[i])) { return -(__LINE__); }
+    }
+
+    return inputSampler::start(inputs().pins(), cfg);
+}
+
+int gpio::startPulseCounting(const pulse::Config& cfg)
+{
+    // the counted pins are no longer inputs of the application, and a line can only be requested once
+    inputs().remove(cfg.pins);
+
+    gpioEvent::deinit();
+
+    if (startEvents()) { return -(__LINE__); }
+
+    return pulse::start(cfg);
+}
+
+int gpio::startPwm(const pwm::Config& cfg)
+{
+    outputs().remove(cfg.pins);
+
+    return pwm::start(cfg);
+}
+
+int gpio::addEncoder(Encoder& encoder)
+{
+    if (encoderCnt >= SIZEOF_ARRAY(encoders))
+    {
+        LOG_ERR("too many encoders");
+        return -(__LINE__);
+    }
+
+    encoders[encoderCnt] = &encoder;
+    ++encoderCnt;
+
+    return 0;
+}
+
+omw::clock::timepoint_t gpio::sampleTime() { return tpSample; }
+
+omw::clock::timepoint_t gpio::changeTime(int pin) { return (((pin >= 0) && (pin < 64)) ? tpChange[pin] : tpSample); }
+
+gpio::InputBank& gpio::inputs()
+{
+    // constructed on first use, the inputs below add their pins during static initialisation
+    static InputBank bank;
+    return bank;
+}
+
+gpio::OutputGroup& gpio::outputs()
+{
+    static OutputGroup group;
+    return group;
 }
 
 
@@ -72,8 +249,8 @@ void gpio::task()
 static gpio::InputActiveHigh ___btn0(GPIO_BTN0);
 static gpio::InputActiveHigh ___btn1(GPIO_BTN1);
 
-static gpio::OutputActiveHigh ___led0(GPIO_LED0);
-static gpio::OutputActiveHigh ___led1(GPIO_LED1);
+static gpio::GroupedOutput ___led0(gpio::outputs(), gpio::Led0::number, gpio::Led0::activeLow);
+static gpio::GroupedOutput ___led1(gpio::outputs(), gpio::Led1::number, gpio::Led1::activeLow);
 
 
 
@@ -82,7 +259,107 @@ namespace gpio {
 Input* const btn0 = &___btn0;
 Input* const btn1 = &___btn1;
 
-Output* const led0 = &___led0;
-Output* const led1 = &___led1;
+GroupedOutput* const led0 = &___led0;
+GroupedOutput* const led1 = &___led1;
 
 } // namespace gpio
+
+
+
+void drainEdges()
+{
+    const uint64_t encPins = (encoderEdges ? encoderPins() : 0);
+    gpioEvent::Edge edges[16];
+    size_t n;
+
+    // the levels are read again if edges were lost, a missed step is then counted as error by the encoder
+    if (encoderEdges && (gpioEvent::lost() != encoderLost))
+    {
+        encoderLost = gpioEvent::lost();
+        encoderLevels = RPIHAL_GPIO_read64() & encPins;
+    }
+
+    while ((n = gpioEvent::drain(edges, SIZEOF_ARRAY(edges))) > 0)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            const uint64_t bit = RPIHAL_GPIO_BIT(edges[i].pin);
+
+            if (encPins & bit)
+            {
+                // one signal per event, so every transition can be decoded
+                if (edges[i].rising) { encoderLevels |= bit; }
+                else { encoderLevels &= ~bit; }
+
+                for (size_t k = 0; k < encoderCnt; ++k)
+                {
+                    if (encoders[k]->pins() & bit) { encoders[k]->update(encoderLevels, edges[i].t_ns); }
+                }
+            }
+
+            // the following edges are bouncing
+            else if ((edgePending & bit) == 0)
+            {
+                firstEdge_ns[edges[i].pin] = edges[i].t_ns;
+                edgePending |= bit;
+            }
+        }
+    }
+
+    // also without an edge, for the velocity
+    if (encoderEdges)
+    {
+        const uint64_t t_ns = util::monotonic_ns();
+        for (size_t i = 0; i < encoderCnt; ++i) { encoders[i]->update(encoderLevels, t_ns); }
+    }
+}
+
+/**
+ * @param sampled `false` if the debounce sample was deferred in this pass, the pending edges are then kept
+ */
+void updateChangeTimes(omw::clock::timepoint_t tpNow, bool sampled)
+{
+    const uint64_t changed = gpio::inputs().pos() | gpio::inputs().neg();
+
+    if (changed)
+    {
+        const uint64_t now_ns = util::monotonic_ns();
+
+        for (int pin = 0; pin < 64; ++pin)
+        {
+            const uint64_t bit = RPIHAL_GPIO_BIT(pin);
+
+            if (changed & bit)
+            {
+                if (edgePending & bit) { tpChange[pin] = tpNow - (omw::clock::timepoint_t)((now_ns - firstEdge_ns[pin]) / 1000); }
+                else { tpChange[pin] = tpSample; }
+            }
+        }
+    }
+
+    // a pin which bounced back to its state has no pending change
+    if (sampled) { edgePending &= gpio::inputs().settling() & ~changed; }
+}
+
+uint64_t encoderPins()
+{
+    uint64_t pins = 0;
+    for (size_t i = 0; i < encoderCnt; ++i) { pins |= encoders[i]->pins(); }
+    return pins;
+}
+
+int startEvents()
+{
+    const uint64_t encPins = encoderPins();
+
+    if (gpioEvent::init(gpio::inputs().pins() | encPins)) { return -(__LINE__); }
+
+    encoderEdges = ((encPins != 0) && gpioEvent::kernelTimestamps());
+    gpioEvent::capture(gpio::inputs().pins() | (encoderEdges ? encPins : 0));
+
+    // read after the lines have been requested, an edge in between is applied to the same level again
+    encoderLevels = RPIHAL_GPIO_read64() & encPins;
+    encoderLost = gpioEvent::lost();
+
+    return 0;
+}
@@ -10,8 +10,15 @@ copyright       MIT - Copyright (c) 2024 Oliver Blaser
 #include <cstdint>
 
 #include "gpio-pins.h"
+#include "middleware/debouncer.h"
+#include "middleware/encoder.h"
+#include "middleware/input-sampler.h"
+#include "middleware/pulse.h"
+#include "middleware/pwm.h"
 #include "project.h"
 
+#include <omw/clock.h>
+
 #include <rpihal/gpio.h>
 
 
@@ -20,6 +27,8 @@ namespace gpio {
 /**
  * @brief Initialises the GPIOs needed by this project.
  *
+ * The inputs are registered as wakeup source of the event loop, so `eventLoop::init()` has to be called before.
+ *
  * @return 0 on success
  */
 int init();
@@ -31,8 +40,81 @@ int init();
  */
 void deinit();
 
+/**
+ * @brief Samples the inputs.
+ *
+ * While an input is settling, it's sampled every `gpio::debounceInterval_us`, so the debounce thresholds are in units
+ * of this interval.
+ */
 void task();
 
+/**
+ * @brief Time of the next debounce sample, `eventLoop::noDeadline` if all inputs are stable.
+ */
+omw::clock::timepoint_t deadline();
+
+/**
+ * @brief Moves the input sampling to a real-time thread (see `inputSampler::start()`).
+ *
+ * The edges are passed to `gpio::task()` through a queue, so none is lost if the main loop is blocked.
+ *
+ * @return 0 on success
+ */
+int startRtSampling(const inputSampler::Config& cfg);
+
+/**
+ * @brief Counts the edges of the pins on a separate thread (see `pulse::start()`).
+ *
+ * The pins are removed from the input bank, the inputs on them stay inactive. Their lines are released by the event
+ * loop, so the counted pins don't wake up the main loop anymore.
+ *
+ * @return 0 on success
+ */
+int startPulseCounting(const pulse::Config& cfg);
+
+/**
+ * @brief Drives the pins with software PWM (see `pwm::start()`).
+ *
+ * The pins are removed from `gpio::outputs()`, so writes to their `Output` views have no effect anymore.
+ *
+ * @return 0 on success
+ */
+int startPwm(const pwm::Config& cfg);
+
+/**
+ * @brief Registers a quadrature encoder, has to be called before `gpio::init()`.
+ *
+ * The pins are initialised as inputs with pull-up. With real-time sampling the encoder is decoded on the sampling
+ * thread. Otherwise `gpio::task()` decodes it from the edge events of the GPIO character device, which are timestamped
+ * and ordered by the kernel, so no step is lost while the main loop is busy (as long as the event buffers don't
+ * overflow). Only if the character device is not available (emulator), the levels are sampled by `gpio::task()`.
+ *
+ * @return 0 on success
+ */
+int addEncoder(Encoder& encoder);
+
+/**
+ * @brief Time at which the inputs were sampled by the last `gpio::task()` call.
+ *
+ * With real-time sampling this is the time of the sample which caused the edge, not the time it was processed.
+ */
+omw::clock::timepoint_t sampleTime();
+
+/**
+ * @brief Time of the last state change of an input.
+ *
+ * If the edges are captured (`gpioEvent::capture()`), this is the timestamp of the first edge of the change, before
+ * debouncing. Otherwise it's the sample time of the change.
+ *
+ * @param pin Pin of an input of `gpio::inputs()`
+ */
+omw::clock::timepoint_t changeTime(int pin);
+
+
+
+constexpr omw::clock::timepoint_t debounceInterval_us = 2000;
+constexpr unsigned defaultDebounceSamples = 5;
+
 
 
 class EdgeDetect // not really GPIO specific, could be moved to another header
@@ -64,13 +146,70 @@ private:
     bool m_state, m_old, m_pos, m_neg;
 };
 
-class Button : public EdgeDetect
+enum PIN_POLARITY
+{
+    PP_activeHigh = 0,
+    PP_activeLow,
+};
+
+/**
+ * @brief Input pin with the pin number and the polarity known at compile time.
+ *
+ * The functions are static, `read()` inlines to a `RPIHAL_GPIO_readPin()` call with a constant argument and
+ * `read(levels)` to a mask operation.
+ */
+template <int pin, int polarity = PP_activeHigh> class InputPin
+{
+public:
+    static constexpr int number = pin;
+    static constexpr uint64_t mask = RPIHAL_GPIO_BIT(pin);
+    static constexpr bool activeLow = (polarity == PP_activeLow);
+
+    static bool read() { return ((RPIHAL_GPIO_readPin(pin) > 0) != activeLow); }
+
+    /**
+     * @param levels Pin levels as returned by `RPIHAL_GPIO_read64()`
+     */
+    static bool read(uint64_t levels) { return (((levels & mask) != 0) != activeLow); }
+
+private:
+    InputPin() = delete;
+};
+
+/**
+ * @brief Output pin with the pin number and the polarity known at compile time.
+ *
+ * The functions are static, `set()` and `clr()` inline to a single `RPIHAL_GPIO_set()` or `RPIHAL_GPIO_clr()` call
+ * with a constant mask.
+ */
+template <int pin, int polarity = PP_activeHigh> class OutputPin
 {
 public:
-    Button() = delete;
+    static constexpr int number = pin;
+    static constexpr uint64_t mask = RPIHAL_GPIO_BIT(pin);
+    static constexpr bool activeLow = (polarity == PP_activeLow);
+
+    static bool read() { return ((RPIHAL_GPIO_readPin(pin) > 0) != activeLow); }
+
+    static void write(bool state)
+    {
+        if (state != activeLow) { RPIHAL_GPIO_set(mask); }
+        else { RPIHAL_GPIO_clr(mask); }
+    }
+
+    static void set() { write(true); }
+    static void clr() { write(false); }
+    static void toggle() { RPIHAL_GPIO_togglePin(pin); }
 
-    explicit Button(int pin)
-        : EdgeDetect(), m_pin(pin)
+private:
+    OutputPin() = delete;
+};
+
+template <int pin, int polarity = PP_activeHigh> class Button : public EdgeDetect
+{
+public:
+    Button()
+        : EdgeDetect()
     {
         handler();
         handler();
@@ -78,50 +217,157 @@ public:
 
     virtual ~Button() {}
 
-    virtual void handler() { EdgeDetect::handler(RPIHAL_GPIO_readPin(m_pin) > 0); }
-
-protected:
-    int m_pin;
+    void handler() { EdgeDetect::handler(InputPin<pin, polarity>::read()); }
 };
 
-class ButtonInverted : public Button
+template <int pin> using ButtonInverted = Button<pin, PP_activeLow>;
+
+/**
+ * @brief Samples a set of input pins with one register read.
+ *
+ * The pin levels are read with `RPIHAL_GPIO_read64()`, converted to logical states with the polarity mask, debounced
+ * and the edges of all pins are computed at once. Bit `n` of the masks corresponds to GPIO `n`.
+ */
+class InputBank
 {
 public:
-    ButtonInverted() = delete;
+    InputBank()
+        : m_pins(0), m_activeLow(0), m_state(0), m_pos(0), m_neg(0), m_debouncer()
+    {}
+
+    virtual ~InputBank() {}
 
-    explicit ButtonInverted(int pin)
-        : Button(pin)
+    /**
+     * @brief Adds a pin to the bank, has to be done before sampling.
+     *
+     * @param debounceSamples Number of equal samples needed to change the state (see `util::Debouncer`)
+     */
+    void add(int pin, bool activeLow, unsigned debounceSamples)
     {
-        handler();
-        handler();
+        const uint64_t bit = RPIHAL_GPIO_BIT(pin);
+
+        m_pins |= bit;
+
+        if (activeLow) { m_activeLow |= bit; }
+        else { m_activeLow &= ~bit; }
+
+        m_debouncer.setThreshold(bit, debounceSamples);
+    }
+
+    /**
+     * @brief Removes pins from the bank, e.g. if they are used by another module. They are inactive and have no edges
+     * afterwards.
+     */
+    void remove(uint64_t mask)
+    {
+        m_pins &= ~mask;
+        m_activeLow &= ~mask;
+        m_state &= ~mask;
+        m_pos &= ~mask;
+        m_neg &= ~mask;
+        m_debouncer.reset(m_state);
+    }
+
+    /**
+     * @brief Bit mask of the pins added to the bank.
+     */
+    uint64_t pins() const { return m_pins; }
+
+    /**
+     * @brief Reads the pins and updates the states and edges.
+     */
+    void sample() { update(RPIHAL_GPIO_read64()); }
+
+    /**
+     * @brief Updates the states and edges.
+     *
+     * @param levels Pin levels as returned by `RPIHAL_GPIO_read64()`
+     */
+    void update(uint64_t levels)
+    {
+        const uint64_t cur = m_debouncer.update((levels ^ m_activeLow) & m_pins);
+
+        m_pos = cur & ~m_state;
+        m_neg = m_state & ~cur;
+        m_state = cur;
     }
 
-    virtual ~ButtonInverted() {}
+    /**
+     * @brief Sets the states without generating edges.
+     *
+     * @param levels Pin levels as returned by `RPIHAL_GPIO_read64()`
+     */
+    void reset(uint64_t levels)
+    {
+        m_state = (levels ^ m_activeLow) & m_pins;
+        m_debouncer.reset(m_state);
+        m_pos = 0;
+        m_neg = 0;
+    }
 
-    virtual void handler() { EdgeDetect::handler(RPIHAL_GPIO_readPin(m_pin) == 0); }
+    /**
+     * @brief Clears the edges, for passes without a new sample.
+     */
+    void clearEdges()
+    {
+        m_pos = 0;
+        m_neg = 0;
+    }
+
+    /**
+     * @brief Bit mask of the pins which are being debounced.
+     */
+    uint64_t settling() const { return m_debouncer.settling(); }
+
+    uint64_t state() const { return m_state; }
+    uint64_t pos() const { return m_pos; }
+    uint64_t neg() const { return m_neg; }
+
+private:
+    uint64_t m_pins;
+    uint64_t m_activeLow;
+    uint64_t m_state; // logical states, 1 = active
+    uint64_t m_pos;
+    uint64_t m_neg;
+    util::Debouncer m_debouncer;
+
+private:
+    InputBank(const InputBank& other) = delete;
+    InputBank(const InputBank&& other) = delete;
+    InputBank& operator=(const InputBank& other);
 };
 
-class Input : private EdgeDetect
+/**
+ * @brief The bank of the inputs of this project, sampled by `gpio::task()`.
+ */
+InputBank& inputs();
+
+/**
+ * @brief View of one pin of an input bank.
+ */
+class Input
 {
 public:
     Input() = delete;
 
-    Input(int pin, bool state)
-        : EdgeDetect(state, state), m_pin(pin)
-    {}
+    Input(InputBank& bank, int pin, bool activeLow, unsigned debounceSamples)
+        : m_bank(bank), m_pin(pin), m_mask(RPIHAL_GPIO_BIT(pin))
+    {
+        bank.add(pin, activeLow, debounceSamples);
+    }
 
     virtual ~Input() {}
 
-    bool state() const { return EdgeDetect::state(); }
-    bool pos() const { return EdgeDetect::pos(); }
-    bool neg() const { return EdgeDetect::neg(); }
+    int pin() const { return m_pin; }
 
-    virtual void handler() = 0;
+    bool state() const { return ((m_bank.state() & m_mask) != 0); }
+    bool pos() const { return ((m_bank.pos() & m_mask) != 0); }
+    bool neg() const { return ((m_bank.neg() & m_mask) != 0); }
 
 protected:
+    const InputBank& m_bank;
     int m_pin;
-
-    void m_handler(bool state) { EdgeDetect::handler(state); }
+    uint64_t m_mask;
 
 private:
     Input(const Input& other) = delete;
@@ -134,13 +380,15 @@ class InputActiveHigh : public Input
 public:
     InputActiveHigh() = delete;
 
-    explicit InputActiveHigh(int pin)
-        : Input(pin, 0)
+    explicit InputActiveHigh(int pin, unsigned debounceSamples = defaultDebounceSamples)
+        : Input(inputs(), pin, false, debounceSamples)
     {}
 
-    virtual ~InputActiveHigh() {}
+    InputActiveHigh(InputBank& bank, int pin, unsigned debounceSamples = defaultDebounceSamples)
+        : Input(bank, pin, false, debounceSamples)
+    {}
 
-    virtual void handler() { m_handler(RPIHAL_GPIO_readPin(m_pin) > 0); }
+    virtual ~InputActiveHigh() {}
 };
 
 class InputActiveLow : public Input
@@ -148,13 +396,15 @@ class InputActiveLow : public Input
 public:
     InputActiveLow() = delete;
 
-    explicit InputActiveLow(int pin)
-        : Input(pin, 1)
+    explicit InputActiveLow(int pin, unsigned debounceSamples = defaultDebounceSamples)
+        : Input(inputs(), pin, true, debounceSamples)
     {}
 
-    virtual ~InputActiveLow() {}
+    InputActiveLow(InputBank& bank, int pin, unsigned debounceSamples = defaultDebounceSamples)
+        : Input(bank, pin, true, debounceSamples)
+    {}
 
-    virtual void handler() { m_handler(RPIHAL_GPIO_readPin(m_pin) == 0); }
+    virtual ~InputActiveLow() {}
 };
 
 class Output
@@ -219,11 +469,198 @@ public:
     virtual void write(bool state) { RPIHAL_GPIO_writePin(m_pin, (state ? 0 : 1)); }
 };
 
+/**
+ * @brief Type erased `gpio::OutputPin`, for code which needs runtime polymorphism.
+ */
+template <class P> class OutputAdapter : public Output
+{
+public:
+    OutputAdapter()
+        : Output(P::number)
+    {}
+
+    virtual ~OutputAdapter() {}
+
+    virtual bool read() const { return P::read(); }
+    virtual void write(bool state) { P::write(state); }
+    virtual void set() { P::set(); }
+    virtual void clr() { P::clr(); }
+    virtual void toggle() { P::toggle(); }
+};
+
+/**
+ * @brief Set of output pins which are switched together.
+ *
+ * Changes are staged into a set and a clear mask and applied by `commit()` with one `RPIHAL_GPIO_set()` and one
+ * `RPIHAL_GPIO_clr()` call. A shadow of the pin states is kept, so reading does not access the hardware. The masks are
+ * logical states (1 = active), bit `n` corresponds to GPIO `n`.
+ */
+class OutputGroup
+{
+public:
+    OutputGroup()
+        : m_pins(0), m_activeLow(0), m_shadow(0), m_set(0), m_clr(0)
+    {}
+
+    virtual ~OutputGroup() {}
+
+    /**
+     * @brief Adds a pin to the group, has to be done before writing.
+     */
+    void add(int pin, bool activeLow)
+    {
+        const uint64_t bit = RPIHAL_GPIO_BIT(pin);
+
+        m_pins |= bit;
+
+        if (activeLow) { m_activeLow |= bit; }
+        else { m_activeLow &= ~bit; }
+    }
+
+    template <class P> void add() { add(P::number, P::activeLow); }
+
+    /**
+     * @brief Removes pins from the group, writes to them are ignored afterwards and the pin levels are not changed.
+     */
+    void remove(uint64_t mask)
+    {
+        m_pins &= ~mask;
+        m_shadow &= ~mask;
+        m_set &= ~mask;
+        m_clr &= ~mask;
+    }
+
+    uint64_t pins() const { return m_pins; }
+
+    /**
+     * @brief Reads the pin levels into the shadow state, e.g. after initialising the pins. Discards the staged changes.
+     */
+    void sync()
+    {
+        m_shadow = RPIHAL_GPIO_read64() & m_pins;
+        m_set = 0;
+        m_clr = 0;
+    }
+
+    /**
+     * @brief Stages the states of the pins in `mask`.
+     */
+    void write(uint64_t mask, uint64_t states)
+    {
+        mask &= m_pins;
+
+        const uint64_t high = (states ^ m_activeLow) & mask;
+
+        m_set = (m_set & ~mask) | high;
+        m_clr = (m_clr & ~mask) | (mask & ~high);
+    }
+
+    void set(uint64_t mask) { write(mask, UINT64_MAX); }
+    void clr(uint64_t mask) { write(mask, 0); }
+    void toggle(uint64_t mask) { write(mask, ~read()); }
+
+    /**
+     * @brief States including the staged changes, does not access the hardware.
+     */
+    uint64_t read() const { return ((((m_shadow & ~m_clr) | m_set) ^ m_activeLow) & m_pins); }
+
+    /**
+     * @return `true` if there are staged changes which differ from the shadow state
+     */
+    bool pending() const { return (((m_set & ~m_shadow) | (m_clr & m_shadow)) != 0); }
+
+    /**
+     * @brief Applies the staged changes.
+     */
+    void commit()
+    {
+        // only the pins which change, the other bits of the registers have no effect anyway
+        const uint64_t set = m_set & ~m_shadow;
+        const uint64_t clr = m_clr & m_shadow;
+
+        if (set) { RPIHAL_GPIO_set(set); }
+        if (clr) { RPIHAL_GPIO_clr(clr); }
+
+        m_shadow = (m_shadow | set) & ~clr;
+        m_set = 0;
+        m_clr = 0;
+    }
+
+private:
+    uint64_t m_pins;
+    uint64_t m_activeLow;
+    uint64_t m_shadow; // pin levels
+    uint64_t m_set;    // staged levels
+    uint64_t m_clr;
+
+private:
+    OutputGroup(const OutputGroup& other) = delete;
+    OutputGroup(const OutputGroup&& other) = delete;
+    OutputGroup& operator=(const OutputGroup& other);
+};
+
+/**
+ * @brief The output group of this project, the LEDs.
+ */
+OutputGroup& outputs();
+
+/**
+ * @brief View of one pin of an output group.
+ *
+ * `write()`, `set()`, `clr()` and `toggle()` are applied immediately, like with the other outputs. To switch several
+ * pins at once, `stage()` them and call `commit()`.
+ */
+class GroupedOutput : public Output
+{
+public:
+    GroupedOutput() = delete;
+
+    GroupedOutput(OutputGroup& group, int pin, bool activeLow)
+        : Output(pin), m_group(group), m_mask(RPIHAL_GPIO_BIT(pin))
+    {
+        group.add(pin, activeLow);
+    }
+
+    virtual ~GroupedOutput() {}
+
+    virtual bool read() const { return ((m_group.read() & m_mask) != 0); }
+
+    virtual void write(bool state)
+    {
+        stage(state);
+        m_group.commit();
+    }
+
+    virtual void toggle()
+    {
+        m_group.toggle(m_mask);
+        m_group.commit();
+    }
+
+    /**
+     * @brief Stages the state, it's applied by `commit()` together with the other staged pins of the group.
+     */
+    void stage(bool state) { m_group.write(m_mask, (state ? m_mask : 0)); }
+
+    /**
+     * @brief Applies the staged changes of all pins of the group.
+     */
+    void commit() { m_group.commit(); }
+
+protected:
+    OutputGroup& m_group;
+    uint64_t m_mask;
+};
+
+using Led0 = OutputPin<GPIO_LED0>;
+using Led1 = OutputPin<GPIO_LED1>;
+
 extern Input* const btn0;
 extern Input* const btn1;
 
-extern Output* const led0;
-extern Output* const led1;
+// views of `gpio::outputs()`
+extern GroupedOutput* const led0;
+extern GroupedOutput* const led1;
 
 } // namespace gpio
 
@@ -0,0 +1,200 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_HISTOGRAM_H
+#define IG_MIDDLEWARE_HISTOGRAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace util {
+
+/**
+ * @brief Fixed memory log-linear histogram (HDR style).
+ *
+ * Each power of two range is split into `nSubBuckets` linear sub buckets, so the relative error of a reported value is
+ * below `1 / nSubBuckets` (~3%) over the whole range. Recording is allocation free and O(1), values above `maxValue`
+ * are clamped. Not thread safe, there has to be only one writer.
+ */
+class Histogram
+{
+public:
+    static constexpr int subBucketBits = 5;
+    static constexpr int maxMsb = 39; // 2^40 ns ~ 18min
+    static constexpr uint64_t nSubBuckets = (1ull << subBucketBits);
+    static constexpr size_t nBuckets = (size_t)((maxMsb - subBucketBits + 2) * nSubBuckets);
+    static constexpr uint64_t maxValue = (1ull << (maxMsb + 1)) - 1;
+
+public:
+    Histogram()
+        : m_buckets(), m_count(0), m_min(UINT64_MAX), m_max(0)
+    {}
+
+    virtual ~Histogram() {}
+
+    void record(uint64_t value)
+    {
+        if (value > maxValue) { value = maxValue; }
+
+        ++m_buckets[index(value)];
+        ++m_count;
+        if (value < m_min) { m_min = value; }
+        if (value > m_max) { m_max = value; }
+    }
+
+    void reset()
+    {
+        for (size_t i = 0; i < nBuckets; ++i) { m_buckets[i] = 0; }
+        m_count = 0;
+        m_min = UINT64_MAX;
+        m_max = 0;
+    }
+
+    uint64_t count() const { return m_count; }
+    uint64_t min() const { return (m_count ? m_min : 0); }
+    uint64_t max() const { return m_max; }
+
+    /**
+     * @param p Percentile in range [0, 100]
+     * @return Highest value equivalent to the bucket containing the percentile, but never more than `max()`
+     */
+    uint64_t percentile(double p) const
+    {
+        if (m_count == 0) { return 0; }
+
+        uint64_t target = (uint64_t)((p / 100.0) * (double)m_count + 0.5);
+        if (target < 1) { target = 1; }
+        if (target > m_count) { target = m_count; }
+
+        uint64_t sum = 0;
+        for (size_t i = 0; i < nBuckets; ++i)
+        {
+            sum += m_buckets[i];
+
+            if (sum >= target)
+            {
+                const uint64_t value = highestEquivalent(i);
+                return (value < m_max ? value : m_max);
+            }
+        }
+
+        return m_max;
+    }
+
+    static size_t index(uint64_t value)
+    {
+        if (value < nSubBuckets) { return (size_t)value; }
+
+        const int shift = msb(value) - subBucketBits;
+        return (size_t)(((uint64_t)shift + 1) * nSubBuckets + ((value >> shift) - nSubBuckets));
+    }
+
+    static uint64_t highestEquivalent(size_t index)
+    {
+        if (index < nSubBuckets) { return (uint64_t)index; }
+
+        const int shift = (int)(index / nSubBuckets) - 1;
+        const uint64_t lower = (nSubBuckets + (index % nSubBuckets)) << shift;
+        return lower + (1ull << shift) - 1;
+    }
+
+private:
+    friend class AtomicHistogram;
+
+    uint32_t m_buckets[nBuckets];
+    uint64_t m_count;
+    uint64_t m_min;
+    uint64_t m_max;
+
+    static int msb(uint64_t value)
+    {
+#if defined(__GNUC__)
+        return 63 - __builtin_clzll(value);
+#else
+        int r = 0;
+        while (value >>= 1) { ++r; }
+        return r;
+#endif
+    }
+};
+
+/**
+ * @brief Histogram which can be recorded to from several threads, lock free.
+ *
+ * The counters are relaxed atomics. A reader sees each counter consistent, but not all of them at the same time, which
+ * is good enough for statistics. Use `snapshot()` to evaluate it.
+ */
+class AtomicHistogram
+{
+public:
+    AtomicHistogram()
+        : m_buckets(), m_min(UINT64_MAX), m_max(0)
+    {}
+
+    virtual ~AtomicHistogram() {}
+
+    void record(uint64_t value)
+    {
+        if (value > Histogram::maxValue) { value = Histogram::maxValue; }
+
+        m_buckets[Histogram::index(value)].fetch_add(1, std::memory_order_relaxed);
+        m_updateMinMax(value, value);
+    }
+
+    /**
+     * @brief Adds all values of a histogram.
+     */
+    void add(const Histogram& other)
+    {
+        if (other.m_count == 0) { return; }
+
+        for (size_t i = 0; i < Histogram::nBuckets; ++i)
+        {
+            if (other.m_buckets[i]) { m_buckets[i].fetch_add(other.m_buckets[i], std::memory_order_relaxed); }
+        }
+
+        m_updateMinMax(other.m_min, other.m_max);
+    }
+
+    void snapshot(Histogram& dst) const
+    {
+        dst.m_count = 0;
+
+        for (size_t i = 0; i < Histogram::nBuckets; ++i)
+        {
+            dst.m_buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+            dst.m_count += dst.m_buckets[i];
+        }
+
+        dst.m_min = m_min.load(std::memory_order_relaxed);
+        dst.m_max = m_max.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint32_t> m_buckets[Histogram::nBuckets];
+    std::atomic<uint64_t> m_min;
+    std::atomic<uint64_t> m_max;
+
+    void m_updateMinMax(uint64_t min, uint64_t max)
+    {
+        uint64_t cur = m_min.load(std::memory_order_relaxed);
+        while ((min < cur) && !m_min.compare_exchange_weak(cur, min, std::memory_order_relaxed)) {}
+
+        cur = m_max.load(std::memory_order_relaxed);
+        while ((max > cur) && !m_max.compare_exchange_weak(cur, max, std::memory_order_relaxed)) {}
+    }
+
+private:
+    AtomicHistogram(const AtomicHistogram& other) = delete;
+    AtomicHistogram(const AtomicHistogram&& other) = delete;
+    AtomicHistogram& operator=(const AtomicHistogram& other);
+};
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_HISTOGRAM_H
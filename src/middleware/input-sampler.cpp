@@ -0,0 +1,162 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include "event-loop.h"
+#include "input-sampler.h"
+#include "middleware/spsc-queue.h"
+#include "middleware/util.h"
+
+#include <omw/defs.h>
+
+#include <rpihal/gpio.h>
+
+#ifndef OMW_PLAT_WIN
+#include <sys/mman.h>
+#endif
+
+
+#define LOG_MODULE_LEVEL LOG_LEVEL_INF
+#define LOG_MODULE_NAME  INSMPL
+#include "middleware/log.h"
+
+
+static std::thread thread;
+static std::atomic<bool> run(false);
+static std::atomic<uint32_t> overrunCnt(0);
+static util::SpscQueue<inputSampler::Event, 64> queue;
+
+static gpio::Encoder* encoders[4];
+static size_t encoderCnt = 0;
+
+static void samplerThread(uint64_t pins, inputSampler::Config cfg);
+static void applyRealtimeConfig(const inputSampler::Config& cfg);
+
+
+
+int inputSampler::start(uint64_t pins, const Config& cfg)
+{
+    if (run) { return 0; }
+
+    if ((cfg.period_us == 0) || (pins == 0))
+    {
+        LOG_ERR("invalid config");
+        return -(__LINE__);
+    }
+
+#ifndef OMW_PLAT_WIN
+    // locks the pages of the whole process, has to be done before the thread stack is created
+    if (cfg.lockMemory && (mlockall(MCL_CURRENT | MCL_FUTURE) != 0))
+    {
+        LOG_WRN("mlockall() failed, errno: %i %s", errno, std::strerror(errno));
+    }
+#endif
+
+    overrunCnt = 0;
+    run = true;
+    thread = std::thread(samplerThread, pins, cfg);
+
+    applyRealtimeConfig(cfg);
+
+    return 0;
+}
+
+void inputSampler::stop()
+{
+    run = false;
+    if (thread.joinable()) { thread.join(); }
+}
+
+bool inputSampler::running() { return run; }
+
+int inputSampler::attach(gpio::Encoder& encoder)
+{
+    if (run || (encoderCnt >= SIZEOF_ARRAY(encoders)))
+    {
+        LOG_ERR("can't attach the encoder");
+        return -(__LINE__);
+    }
+
+    encoders[encoderCnt] = &encoder;
+    ++encoderCnt;
+
+    return 0;
+}
+
+bool inputSampler::pop(Event& event) { return queue.pop(event); }
+
+bool inputSampler::pending() { return !queue.empty(); }
+
+uint32_t inputSampler::overruns() { return overrunCnt; }
+
+
+
+void samplerThread(uint64_t pins, inputSampler::Config cfg)
+{
+    const uint64_t t0_ns = util::monotonic_ns();
+    const uint64_t levels0 = RPIHAL_GPIO_read64();
+
+    for (size_t i = 0; i < encoderCnt; ++i) { encoders[i]->reset(levels0, t0_ns); }
+
+    uint64_t old = levels0 & pins;
+
+    // the initial state, so that the application starts with the correct levels
+    inputSampler::Event event;
+    event.levels = old;
+    event.changed = 0;
+    event.t_ns = util::monotonic_ns();
+    queue.push(event);
+    eventLoop::wakeup();
+
+    uint64_t next = util::monotonic_ns();
+
+    while (run)
+    {
+        // absolute wakeup times, so that the period does not drift by the loop duration
+        next += (uint64_t)cfg.period_us * 1000;
+        util::sleep_until(next);
+
+        // one bank read for the inputs and the encoders
+        const uint64_t raw = RPIHAL_GPIO_read64();
+        const uint64_t levels = raw & pins;
+        const uint64_t t_ns = util::monotonic_ns();
+
+        for (size_t i = 0; i < encoderCnt; ++i) { encoders[i]->update(raw, t_ns); }
+
+        if (levels != old)
+        {
+            event.levels = levels;
+            event.changed = levels ^ old;
+            event.t_ns = t_ns;
+
+            if (queue.push(event))
+            {
+                old = levels;
+                eventLoop::wakeup();
+            }
+            else { ++overrunCnt; } // old is not updated, the change is reported again with the next sample
+        }
+    }
+}
+
+void applyRealtimeConfig(const inputSampler::Config& cfg)
+{
+    int err;
+
+    err = util::setThreadPriority(thread, cfg.priority);
+    if (err) { LOG_WRN("failed to set SCHED_FIFO priority %i, err: %i %s", cfg.priority, err, std::strerror(err)); }
+
+    if (cfg.cpu >= 0)
+    {
+        err = util::setThreadAffinity(thread, cfg.cpu);
+        if (err) { LOG_WRN("failed to set CPU affinity to %i, err: %i %s", cfg.cpu, err, std::strerror(err)); }
+    }
+}
@@ -0,0 +1,86 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_INPUTSAMPLER_H
+#define IG_MIDDLEWARE_INPUTSAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "middleware/encoder.h"
+
+
+namespace inputSampler {
+
+struct Config
+{
+    uint32_t period_us;
+    int priority;    // SCHED_FIFO priority [1, 99]
+    int cpu;         // CPU to pin the thread to, -1 for no affinity
+    bool lockMemory; // mlockall() to prevent page faults
+};
+
+struct Event
+{
+    uint64_t levels;  // raw pin levels of the sampled pins
+    uint64_t changed; // pins which changed since the previous event
+    uint64_t t_ns;    // sample time (`util::monotonic_ns()`)
+};
+
+static inline Config defaultConfig()
+{
+    Config cfg;
+    cfg.period_us = 1000;
+    cfg.priority = 50;
+    cfg.cpu = -1;
+    cfg.lockMemory = true;
+    return cfg;
+}
+
+/**
+ * @brief Starts the sampling thread.
+ *
+ * The pins are sampled with `RPIHAL_GPIO_read64()` every `period_us` on a real-time thread. Changes are passed to the
+ * application through a lock-free SPSC queue and the event loop is woken up. If the real-time policy, the affinity or
+ * the memory locking can't be applied (missing privileges), a warning is printed and sampling runs anyway.
+ *
+ * @param pins Bit mask of the pins to sample (`RPIHAL_GPIO_BIT()`)
+ * @param cfg Configuration
+ * @return 0 on success
+ */
+int start(uint64_t pins, const Config& cfg);
+
+void stop();
+
+bool running();
+
+/**
+ * @brief Decodes the encoder on the sampling thread, with every sample from the same bank read as the pins.
+ *
+ * Has to be called before `inputSampler::start()`. The encoder pins don't have to be in the sampled pins, their
+ * changes are not passed through the queue.
+ *
+ * @return 0 on success
+ */
+int attach(gpio::Encoder& encoder);
+
+/**
+ * @brief Pops the oldest event, must only be called from the main loop thread.
+ *
+ * @return `false` if no event is pending
+ */
+bool pop(Event& event);
+
+bool pending();
+
+/**
+ * @return Number of events dropped because the queue was full
+ */
+uint32_t overruns();
+
+} // namespace inputSampler
+
+
+#endif // IG_MIDDLEWARE_INPUTSAMPLER_H
@@ -7,9 +7,12 @@ copyright       MIT - Copyright (c) 2025 Oliver Blaser
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <mutex>
 
+#include "event-loop.h"
 #include "gpio-pins.h"
 #include "led-bar.h"
+#include "spi-bus.h"
 
 #include <rpihal/gpio.h>
 #include <rpihal/spi.h>
@@ -23,11 +26,23 @@ copyright       MIT - Copyright (c) 2025 Oliver Blaser
 #define LATCH_AS_nCS   (1) // driving the latch pin like a nCS signal, helps logic analyzers
 #define MAX_CLOCK_FREQ (411000)
 
+#define DEFAULT_MAX_REFRESH_RATE (100) // Hz
+
 
 
 static RPIHAL_SPI_instance_t ___spi;
 static RPIHAL_SPI_instance_t* const spi = &___spi;
 
+// shadow register
+static uint8_t stagedValue = 0;
+static uint8_t writtenValue = 0;
+static bool dirty = true;
+static bool srValid = false; // the content of the shift register is unknown until the first write
+static omw::clock::timepoint_t minPeriod_us = omw::clock::second_us / DEFAULT_MAX_REFRESH_RATE;
+static omw::clock::timepoint_t tpLastWrite = 0;
+
+static int writeSR(uint8_t value);
+
 
 
 #ifdef RPIHAL_EMU
@@ -58,7 +73,7 @@ int ledBar::init()
         return -(__LINE__);
     }
 
-    err = RPIHAL_SPI_open(spi, "/dev/spidev0.0", MAX_CLOCK_FREQ, RPIHAL_SPI_CFG_MODE_0 | RPIHAL_SPI_CFG_NO_CS);
+    err = RPIHAL_SPI_open(spi, "/dev/spidev0.0", MAX_CLOCK_FREQ, spiBus::spi0Flags());
     if (err)
     {
         LOG_ERR("failed to open SPI, err: %i, errno: %i %s", err, errno, std::strerror(errno));
@@ -76,6 +91,11 @@ void ledBar::deinit()
 {
     int err;
 
+    flush(); // the last staged value has to be displayed
+
+    srValid = false;
+    dirty = true;
+
     err = RPIHAL_GPIO_resetPin(GPIO_SR_LATCH);
     if (err) { LOG_ERR("failed to deinit latch pin: %i", err); }
 
@@ -83,6 +103,39 @@ void ledBar::deinit()
     if (err) { LOG_ERR("failed to close SPI, err: %i, errno: %i %s", err, errno, std::strerror(errno)); }
 }
 
+void ledBar::task()
+{
+    if (dirty && (omw::clock::now() >= deadline())) { flush(); }
+}
+
+void ledBar::flush()
+{
+    if (!dirty) { return; }
+
+    tpLastWrite = omw::clock::now();
+
+    // stays dirty on error, it's retried after the refresh period
+    if (writeSR(stagedValue) == 0)
+    {
+        writtenValue = stagedValue;
+        srValid = true;
+        dirty = false;
+    }
+}
+
+omw::clock::timepoint_t ledBar::deadline()
+{
+    if (!dirty) { return eventLoop::noDeadline; }
+
+    return tpLastWrite + minPeriod_us;
+}
+
+void ledBar::setMaxRefreshRate(uint32_t hz)
+{
+    if (hz == 0) { minPeriod_us = 0; }
+    else { minPeriod_us = omw::clock::second_us / hz; }
+}
+
 void ledBar::setBar(int value)
 {
     const uint8_t tmp = (uint8_t)((1 << (value % 9)) - 1);
@@ -93,9 +146,23 @@ void ledBar::setBar(int value)
 }
 
 void ledBar::setValue(uint8_t value)
+{
+    stagedValue = value;
+
+    // re-evaluated on every call, a value can be changed back before it has been written
+    dirty = (!srValid || (stagedValue != writtenValue));
+}
+
+uint8_t ledBar::value() { return stagedValue; }
+
+
+
+int writeSR(uint8_t value)
 {
     uint8_t rxDummy[1];
 
+    std::lock_guard<std::mutex> lock(spiBus::spi0());
+
 #if LATCH_AS_nCS
     RPIHAL_GPIO_writePin(GPIO_SR_LATCH, 0);
 #endif // LATCH_AS_nCS
@@ -115,12 +182,14 @@ void ledBar::setValue(uint8_t value)
 #else  // LATCH_AS_nCS
     RPIHAL_GPIO_writePin(GPIO_SR_LATCH, 1);
 #endif // LATCH_AS_nCS
+
+    return (err ? -(__LINE__) : 0);
 }
 
 
 
 #ifdef RPIHAL_EMU
-#include <stdio.h>
+#include "term.h"
 extern "C" int ledbar_spi_emu_transfer_callback(const uint8_t* txData, uint8_t* rxBuffer, size_t count)
 {
     int r = -1;
@@ -129,13 +198,7 @@ extern "C" int ledbar_spi_emu_transfer_callback(const uint8_t* txData, uint8_t*
     {
         const int value = txData[0];
 
-        const char* const format = "\033[20C"                         // cursor forward
-                                   "0x%02x "                          // value
-                                   "%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s" // bits SGR
-                                   "\033[49;39m"                      // SGR reset BG and FG
-                                   "\r";                              // cursor return
-
-
+        constexpr int col = 20; // cell of the status line
 
 #ifdef _WIN32
         const char* const lc = "\xE2\x96\xA0"; // LED char
@@ -147,16 +210,13 @@ extern "C" int ledbar_spi_emu_transfer_callback(const uint8_t* txData, uint8_t*
         const char* const sgrOff = "\033[38:5:237m";
 #endif
 
-        const char* const sgr_b0 = (value & 0x01 ? sgrOn : sgrOff);
-        const char* const sgr_b1 = (value & 0x02 ? sgrOn : sgrOff);
-        const char* const sgr_b2 = (value & 0x04 ? sgrOn : sgrOff);
-        const char* const sgr_b3 = (value & 0x08 ? sgrOn : sgrOff);
-        const char* const sgr_b4 = (value & 0x10 ? sgrOn : sgrOff);
-        const char* const sgr_b5 = (value & 0x20 ? sgrOn : sgrOff);
-        const char* const sgr_b6 = (value & 0x40 ? sgrOn : sgrOff);
-        const char* const sgr_b7 = (value & 0x80 ? sgrOn : sgrOff);
+        term::putf(col, 5, "0x%02x", value);
 
-        printf(format, value, sgr_b7, lc, sgr_b6, lc, sgr_b5, lc, sgr_b4, lc, sgr_b3, lc, sgr_b2, lc, sgr_b1, lc, sgr_b0, lc);
+        for (int i = 0; i < 8; ++i)
+        {
+            const int bit = 7 - i;
+            term::put(col + 5 + i, lc, (value & (1 << bit) ? sgrOn : sgrOff));
+        }
 
         r = 0;
     }
@@ -9,19 +9,53 @@ copyright       MIT - Copyright (c) 2025 Oliver Blaser
 #include <cstddef>
 #include <cstdint>
 
+#include <omw/clock.h>
+
 
 namespace ledBar {
 
 int init();
 void deinit();
 
+/**
+ * @brief Writes the staged value to the shift register if it changed and the maximum refresh rate allows it.
+ *
+ * Has to be called from the main loop.
+ */
+void task();
+
+/**
+ * @brief Writes the staged value immediately if it changed, ignoring the maximum refresh rate.
+ */
+void flush();
+
+/**
+ * @return Time at which `ledBar::task()` writes a pending value, `eventLoop::noDeadline` if nothing is pending
+ */
+omw::clock::timepoint_t deadline();
+
+/**
+ * @param hz Maximum number of shift register writes per second, 0 for unlimited
+ */
+void setMaxRefreshRate(uint32_t hz);
+
 /**
  * @param value Bar value in range [0, 8]
  */
 void setBar(int value);
 
+/**
+ * @brief Stages the value, it's written by `ledBar::task()` or `ledBar::flush()`.
+ *
+ * Setting the value which is already displayed costs no bus transfer.
+ */
 void setValue(uint8_t value);
 
+/**
+ * @return The staged value
+ */
+uint8_t value();
+
 }
 
 
@@ -0,0 +1,203 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "middleware/log-format.h"
+#include "middleware/timestamp.h"
+#include "middleware/util.h"
+
+#include <omw/defs.h>
+
+#ifndef OMW_PLAT_WIN
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+#define LOG_MODULE_LEVEL LOG_LEVEL_INF
+#define LOG_MODULE_NAME  LOG
+#include "middleware/log.h"
+
+
+// the LOG_* calls of this module are done while the binary sink is not active
+
+
+std::atomic<bool> ___log_binary(false);
+
+static std::atomic<uint8_t*> base(nullptr);
+static std::atomic<size_t> offset(0);
+static std::atomic<uint32_t> droppedCnt(0);
+static size_t mapSize = 0;
+static uint32_t session = 0; // incremented with each start, so the definitions are written again to the new file
+static int fd = -1;
+
+static uint8_t* reserve(size_t size);
+static void writeDefinition(const ___log_site& site, const char* format, uint32_t sess);
+
+
+
+int logging::startBinary(const char* filename, size_t size)
+{
+#ifndef OMW_PLAT_WIN
+
+    if (___log_binary) { return 0; }
+
+    if (size < (sizeof(BinFileHeader) + 4096))
+    {
+        LOG_ERR("binary log file size too small: %zu", size);
+        return -(__LINE__);
+    }
+
+    fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        LOG_ERR("failed to open \"%s\", errno: %i %s", filename, errno, std::strerror(errno));
+        return -(__LINE__);
+    }
+
+    // sparse file, the pages are allocated when they are written
+    if (ftruncate(fd, (off_t)size) != 0)
+    {
+        LOG_ERR("failed to resize \"%s\", errno: %i %s", filename, errno, std::strerror(errno));
+        close(fd);
+        fd = -1;
+        return -(__LINE__);
+    }
+
+    void* const p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED)
+    {
+        LOG_ERR("failed to map \"%s\", errno: %i %s", filename, errno, std::strerror(errno));
+        close(fd);
+        fd = -1;
+        return -(__LINE__);
+    }
+
+    BinFileHeader header;
+    std::memcpy(header.magic, binMagic, sizeof(header.magic));
+    header.byteOrder = binByteOrder;
+    header.version = binVersion;
+    header.anchorMono_ns = util::monotonic_ns();
+    header.anchorWall_ns = util::monotonic_to_wall_ns(header.anchorMono_ns);
+    std::memcpy(p, &header, sizeof(header));
+
+    LOG_INF("logging to \"%s\"", filename);
+
+    mapSize = size;
+    ++session;
+    droppedCnt = 0;
+    offset.store(binAlign(sizeof(header)), std::memory_order_relaxed);
+    base.store((uint8_t*)p, std::memory_order_release);
+    ___log_binary = true;
+
+    return 0;
+
+#else  // OMW_PLAT_WIN
+    LOG_ERR("the binary log is not supported on this platform");
+    return -(__LINE__);
+#endif // OMW_PLAT_WIN
+}
+
+void logging::stopBinary()
+{
+#ifndef OMW_PLAT_WIN
+
+    if (!___log_binary) { return; }
+
+    // into the file, the call sites which went silent are otherwise never reported
+    ___log_flushPending();
+
+    ___log_binary = false;
+    uint8_t* const p = base.exchange(nullptr);
+
+    size_t used = offset.load();
+    if (used > mapSize) { used = mapSize; }
+
+    if (munmap(p, mapSize) != 0) { LOG_ERR("munmap() failed, errno: %i %s", errno, std::strerror(errno)); }
+    if (ftruncate(fd, (off_t)used) != 0) { LOG_ERR("failed to truncate the binary log file, errno: %i %s", errno, std::strerror(errno)); }
+    close(fd);
+    fd = -1;
+
+    LOG_INF("binary log: %zu bytes written, %u lines dropped", used, (unsigned)droppedCnt);
+
+#endif // OMW_PLAT_WIN
+}
+
+
+
+void ___log_writeBinary(___log_site& site, const char* format, const ___log_args& args, uint64_t t_ns)
+{
+    if (!base.load(std::memory_order_acquire)) { return; }
+
+    // the decoder reads all definitions first, so it does not matter if an event of an other thread is written before
+    const uint32_t sess = session;
+    if ((site.defined.load(std::memory_order_relaxed) != sess) && (site.defined.exchange(sess) != sess)) { writeDefinition(site, format, sess); }
+
+    uint8_t* const record = reserve(sizeof(logging::BinRecordHeader) + args.size);
+    if (!record) { return; }
+
+    logging::BinRecordHeader header;
+    header.type = logging::BRT_event;
+    header.flags = (args.truncated ? logging::BRF_truncated : 0);
+    header.size = args.size;
+    header.id = site.id;
+    header.t_ns = t_ns;
+
+    std::memcpy(record + sizeof(header), args.payload, args.size);
+    std::memcpy(record, &header, sizeof(header));
+}
+
+
+
+uint8_t* reserve(size_t size)
+{
+    uint8_t* const p = base.load(std::memory_order_acquire);
+    size = logging::binAlign(size);
+
+    const size_t off = offset.fetch_add(size, std::memory_order_relaxed);
+
+    if (!p || ((off + size) > mapSize))
+    {
+        ++droppedCnt;
+        return nullptr;
+    }
+
+    return p + off;
+}
+
+void writeDefinition(const ___log_site& site, const char* format, uint32_t sess)
+{
+    const size_t fileLen = std::strlen(site.file) + 1;
+    const size_t formatLen = std::strlen(format) + 1;
+    const size_t size = sizeof(uint32_t) + fileLen + formatLen;
+
+    if (size > UINT16_MAX) { return; }
+
+    uint8_t* const record = reserve(sizeof(logging::BinRecordHeader) + size);
+    if (!record) { return; }
+
+    logging::BinRecordHeader header;
+    header.type = logging::BRT_def;
+    header.flags = 0;
+    header.size = (uint16_t)size;
+    header.id = site.id;
+    header.t_ns = 0;
+
+    const uint32_t line = (uint32_t)site.line;
+    uint8_t* p = record + sizeof(header);
+    std::memcpy(p, &line, sizeof(line));
+    p += sizeof(line);
+    std::memcpy(p, site.file, fileLen);
+    p += fileLen;
+    std::memcpy(p, format, formatLen);
+
+    std::memcpy(record, &header, sizeof(header));
+}
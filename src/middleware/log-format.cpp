@@ -0,0 +1,217 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "log-format.h"
+
+
+// no logging and no project dependencies in this module, it's also used by the log decoder tool
+
+
+static size_t formatSpec(char* buffer, size_t size, const char* spec, size_t specLen, const uint8_t*& arg, const uint8_t* argEnd);
+static size_t lengthBits(const char* spec, size_t specLen);
+
+
+
+size_t logging::formatMessage(char* buffer, size_t size, const char* format, const uint8_t* args, size_t argsSize)
+{
+    if (size == 0) { return 0; }
+
+    size_t len = 0;
+
+    const uint8_t* arg = args;
+    const uint8_t* const argEnd = args + argsSize;
+    const char* p = format;
+
+    while ((*p != 0) && ((len + 1) < size))
+    {
+        if (*p != '%')
+        {
+            buffer[len++] = *(p++);
+            continue;
+        }
+
+        if (*(p + 1) == '%')
+        {
+            buffer[len++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // conversion spec: %[flags][width][.precision][length]conversion
+        const char* const spec = p++;
+        while ((*p != 0) && std::strchr("-+ #0", *p)) { ++p; }
+        while ((*p != 0) && std::strchr("0123456789*.", *p)) { ++p; }
+        while ((*p != 0) && std::strchr("hlzjtL", *p)) { ++p; }
+        if (*p != 0) { ++p; }
+
+        len += formatSpec(buffer + len, size - len, spec, (size_t)(p - spec), arg, argEnd);
+    }
+
+    buffer[len] = 0;
+
+    // truncated lines are terminated anyway
+    if ((len > 0) && (buffer[len - 1] != '\n'))
+    {
+        if ((len + 1) >= size) { --len; }
+        buffer[len++] = '\n';
+        buffer[len] = 0;
+    }
+
+    return len;
+}
+
+
+
+// formats one conversion spec with the captured argument, the value is converted to the type expected by the spec
+size_t formatSpec(char* buffer, size_t size, const char* spec, size_t specLen, const uint8_t*& arg, const uint8_t* argEnd)
+{
+    char fmt[32];
+    int n = 0;
+
+    const char conv = spec[specLen - 1];
+
+    // the spec without length modifiers, they are replaced by the ones of the converted type
+    size_t fmtLen = 0;
+    for (size_t i = 0; (i < (specLen - 1)) && (fmtLen < (sizeof(fmt) - 4)); ++i)
+    {
+        if (!std::strchr("hlzjtL*", spec[i])) { fmt[fmtLen++] = spec[i]; }
+    }
+
+    if ((arg >= argEnd) || (std::memchr(spec, '*', specLen) != nullptr)) { n = std::snprintf(buffer, size, "<?>"); }
+    else
+    {
+        const uint8_t type = *(arg++);
+
+        if (type == logging::AT_str)
+        {
+            const size_t strLen = *(arg++);
+
+            // the captured string isn't null terminated, its length is the precision, limited by the one of the spec
+            size_t precision = strLen;
+            const char* const dot = (const char*)std::memchr(fmt, '.', fmtLen);
+            if (dot != nullptr)
+            {
+                size_t userPrecision = 0;
+                for (const char* c = dot + 1; c < (fmt + fmtLen); ++c) { userPrecision = userPrecision * 10 + (size_t)(*c - '0'); }
+                if (userPrecision < precision) { precision = userPrecision; }
+
+                fmtLen = (size_t)(dot - fmt);
+            }
+
+            fmt[fmtLen++] = '.';
+            fmt[fmtLen++] = '*';
+            fmt[fmtLen++] = 's';
+            fmt[fmtLen] = 0;
+
+            if (conv == 's') { n = std::snprintf(buffer, size, fmt, (int)precision, (const char*)arg); }
+            else { n = std::snprintf(buffer, size, "<%.*s>", (int)strLen, (const char*)arg); }
+
+            arg += strLen;
+        }
+        else
+        {
+            uint64_t raw;
+            std::memcpy(&raw, arg, sizeof(raw));
+            arg += sizeof(raw);
+
+            int64_t i64;
+            double d;
+            std::memcpy(&i64, &raw, sizeof(raw));
+            std::memcpy(&d, &raw, sizeof(raw));
+
+            if (type == logging::AT_double) { i64 = (int64_t)d; }
+            else if (type == logging::AT_int) { d = (double)i64; }
+            else { d = (double)raw; }
+
+            // the integer conversions get the 64 bit length modifier
+            if (std::strchr("diouxXc", conv))
+            {
+                if (conv != 'c')
+                {
+                    fmt[fmtLen++] = 'l';
+                    fmt[fmtLen++] = 'l';
+                }
+                fmt[fmtLen++] = conv;
+                fmt[fmtLen] = 0;
+
+                if (conv == 'c') { n = std::snprintf(buffer, size, fmt, (int)i64); }
+                else if ((conv == 'd') || (conv == 'i')) { n = std::snprintf(buffer, size, fmt, (long long)i64); }
+                else
+                {
+                    // a negative value of an unsigned spec wraps around the size given by the length modifier
+                    unsigned long long u = (unsigned long long)i64;
+                    const size_t bits = lengthBits(spec, specLen);
+                    if (bits < 64) { u &= ((1ull << bits) - 1); }
+
+                    n = std::snprintf(buffer, size, fmt, u);
+                }
+            }
+            else if (std::strchr("fFeEgGaA", conv))
+            {
+                fmt[fmtLen++] = conv;
+                fmt[fmtLen] = 0;
+                n = std::snprintf(buffer, size, fmt, d);
+            }
+            else if (conv == 'p')
+            {
+                fmt[fmtLen++] = 'p';
+                fmt[fmtLen] = 0;
+                n = std::snprintf(buffer, size, fmt, (const void*)(uintptr_t)raw);
+            }
+            else { n = std::snprintf(buffer, size, "<?>"); }
+        }
+    }
+
+    if (n < 0) { return 0; }
+    return ((size_t)n < size ? (size_t)n : size - 1);
+}
+
+// size of the integer type given by the length modifier of the spec
+size_t lengthBits(const char* spec, size_t specLen)
+{
+    size_t nh = 0, nl = 0;
+    size_t bits = 8 * sizeof(int);
+
+    for (size_t i = 0; i < specLen; ++i)
+    {
+        switch (spec[i])
+        {
+        case 'h':
+            ++nh;
+            break;
+
+        case 'l':
+            ++nl;
+            break;
+
+        case 'j':
+            bits = 8 * sizeof(intmax_t);
+            break;
+
+        case 'z':
+            bits = 8 * sizeof(size_t);
+            break;
+
+        case 't':
+            bits = 8 * sizeof(ptrdiff_t);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    if (nh == 1) { bits = 8 * sizeof(short); }
+    else if (nh >= 2) { bits = 8 * sizeof(char); }
+    else if (nl == 1) { bits = 8 * sizeof(long); }
+    else if (nl >= 2) { bits = 8 * sizeof(long long); }
+
+    return bits;
+}
@@ -0,0 +1,87 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_LOGFORMAT_H
+#define IG_MIDDLEWARE_LOGFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace logging {
+
+/**
+ * @brief Type tags of the captured arguments.
+ *
+ * Each argument is encoded as the tag followed by the 8 byte value (host byte order), strings as the tag, one length
+ * byte and the characters without null terminator.
+ */
+enum ARG_TYPE : uint8_t
+{
+    AT_int = 1,
+    AT_uint,
+    AT_double,
+    AT_str,
+    AT_ptr,
+};
+
+/**
+ * @brief Formats a message with the captured arguments.
+ *
+ * Each conversion spec is formatted separately, the captured value is converted to the type expected by the spec.
+ * Missing arguments are printed as `<?>`. The message is always terminated with a new line.
+ *
+ * @param buffer Destination, always null terminated if `size > 0`
+ * @param format printf format string
+ * @param args Encoded arguments (`logging::ARG_TYPE`)
+ * @param argsSize Number of bytes of `args`
+ * @return Number of characters written, excluding the null terminator
+ */
+size_t formatMessage(char* buffer, size_t size, const char* format, const uint8_t* args, size_t argsSize);
+
+
+
+// binary log file, host byte order, records aligned to 8 bytes
+
+constexpr char binMagic[8] = { 'R', 'P', 'H', 'L', 'O', 'G', 'B', 0 };
+constexpr uint32_t binByteOrder = 0x01020304;
+constexpr uint32_t binVersion = 1;
+
+struct BinFileHeader
+{
+    char magic[8];
+    uint32_t byteOrder;
+    uint32_t version;
+    int64_t anchorWall_ns;  // wall clock time of `anchorMono_ns`, ns since the epoch
+    uint64_t anchorMono_ns; // `util::monotonic_ns()`
+};
+
+enum BIN_RECORD_TYPE : uint8_t
+{
+    BRT_end = 0,     // unused space of the file
+    BRT_def = 'D',   // call site definition, payload: uint32 line, file and format string (null terminated)
+    BRT_event = 'E', // log call, payload: encoded arguments (`logging::ARG_TYPE`)
+};
+
+constexpr uint8_t BRF_truncated = 0x01; // not all arguments did fit
+
+struct BinRecordHeader
+{
+    uint8_t type;
+    uint8_t flags;
+    uint16_t size; // payload size, excluding the header and the alignment padding
+    uint32_t id;   // call site ID
+    uint64_t t_ns; // `util::monotonic_ns()`
+};
+
+static_assert(sizeof(BinFileHeader) == 32, "unexpected binary log file header size");
+static_assert(sizeof(BinRecordHeader) == 16, "unexpected binary log record header size");
+
+static inline size_t binAlign(size_t size) { return ((size + 7) & ~(size_t)7); }
+
+} // namespace logging
+
+
+#endif // IG_MIDDLEWARE_LOGFORMAT_H
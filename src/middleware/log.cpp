@@ -0,0 +1,679 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cctype>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "middleware/log-format.h"
+#include "middleware/term.h"
+#include "middleware/timestamp.h"
+#include "middleware/util.h"
+
+
+#define LOG_MODULE_LEVEL LOG_LEVEL_INF
+#define LOG_MODULE_NAME  LOG
+#include "middleware/log.h"
+
+
+// no LOG_* calls in this module, the backend would log into the ring it is draining
+
+
+namespace {
+
+struct Entry
+{
+    std::atomic<size_t> seq; // slot state of the ring
+    size_t pos;              // ring position, owned by the producer until published
+    const char* format;
+    uint64_t t_ns; // `util::monotonic_ns()`, converted to wall clock time by the backend
+    ___log_args args;
+};
+
+// counts of a call site which went silent
+struct PendingReport
+{
+    const ___log_site* site;
+    uint32_t identical;
+    uint32_t limited;
+};
+
+} // namespace
+
+static constexpr size_t ringSize = 256; // has to be a power of two
+static_assert((ringSize & (ringSize - 1)) == 0, "ringSize has to be a power of two");
+
+static constexpr size_t lineBufferSize = 1024;
+static constexpr size_t outBufferSize = 4096;
+
+static Entry ring[ringSize];
+static std::atomic<size_t> enqueuePos(0);
+static size_t dequeuePos = 0;
+
+static std::atomic<bool> running(false);
+static std::atomic<bool> stopRequest(false);
+static std::atomic<int> fullPolicy(logging::FP_drop);
+static std::atomic<uint32_t> droppedCnt(0);
+static std::thread thread;
+static std::mutex mtx;
+static std::condition_variable cv;
+
+// used by the caller if the backend is not running
+static thread_local Entry syncEntry;
+
+static ___log_module* modules = nullptr;
+static std::mutex modulesMtx;
+
+static std::atomic<uint32_t> rateBurst(20);
+static std::atomic<uint64_t> ratePeriod_ns(1000000000);
+static std::atomic<uint64_t> dedup_ns(10000000000);
+
+// call sites with suppressed lines, only changes when a call site starts to suppress
+static std::vector<___log_site*> pendingSites;
+static std::mutex pendingMtx;
+
+// without the backend thread (sync mode, binary sink) the pending counts are reported by the next calls
+static constexpr uint64_t flushPeriod_ns = 100000000;
+static std::atomic<uint64_t> flush_ns(0);
+
+static constexpr const char* identicalFormat = "\033[93m%s <WRN> %u identical messages suppressed (%s:%i)\033[39m\n";
+static constexpr const char* limitedFormat = "\033[93m%s <WRN> %u messages suppressed by the rate limit (%s:%i)\033[39m\n";
+static ___log_site identicalSite(___log_siteId(__FILE__, __LINE__, identicalFormat), __FILE__, __LINE__, ___LOG_STR(LOG_MODULE_NAME), LOG_LEVEL_WRN);
+static ___log_site limitedSite(___log_siteId(__FILE__, __LINE__, limitedFormat), __FILE__, __LINE__, ___LOG_STR(LOG_MODULE_NAME), LOG_LEVEL_WRN);
+
+static void backendThread();
+static void buildReport(___log_args& args, const ___log_site& reported, uint32_t count);
+static Entry* claim(const char* format, uint64_t t_ns);
+static size_t collectPending(bool all, uint64_t now, PendingReport* reports, size_t maxCount);
+static void emit(___log_site& site, const char* format, const ___log_args& args, uint64_t t_ns);
+static bool filter(___log_site& site, const ___log_args& args, uint64_t t_ns, uint32_t& identical, uint32_t& limited);
+static void flushPending(bool all, bool wait);
+static size_t formatEntry(const Entry& entry, char* buffer, size_t size);
+static uint32_t hashArgs(const ___log_args& args);
+static bool iequals(const char* a, const char* b);
+static void initRing();
+static int parseLevel(const std::string& str);
+static size_t reportPending(char* buffer, size_t size, bool all);
+static bool tryLock(___log_site& site);
+static void unlock(___log_site& site);
+
+
+
+int logging::start(int policy)
+{
+    if (running) { return 0; }
+
+    initRing();
+    pendingSites.reserve(32);
+
+    fullPolicy = policy;
+    droppedCnt = 0;
+    stopRequest = false;
+    running = true;
+    thread = std::thread(backendThread);
+
+    return 0;
+}
+
+void logging::stop()
+{
+    if (!running) { return; }
+
+    stopRequest = true;
+    cv.notify_one();
+
+    if (thread.joinable()) { thread.join(); }
+
+    // the backend reports only as many call sites as fit into its buffer
+    flushPending(true, true);
+}
+
+uint32_t logging::dropped() { return droppedCnt; }
+
+int logging::setLevel(const char* module, int level)
+{
+    if ((level < LOG_LEVEL_OFF) || (level > LOG_LEVEL_DBG)) { return -(__LINE__); }
+
+    const bool all = (std::strcmp(module, "*") == 0);
+    bool found = false;
+
+    std::lock_guard<std::mutex> lock(modulesMtx);
+
+    // more than one translation unit can have the same module name
+    for (___log_module* m = modules; m; m = m->next)
+    {
+        if (all || iequals(m->name, module))
+        {
+            m->level.store(level, std::memory_order_relaxed);
+            found = true;
+        }
+    }
+
+    return (found ? 0 : -(__LINE__));
+}
+
+int logging::setLevels(const char* spec)
+{
+    int r = 0;
+    const std::string str = spec;
+    size_t pos = 0;
+
+    while ((r == 0) && (pos <= str.length()))
+    {
+        size_t end = str.find(',', pos);
+        if (end == std::string::npos) { end = str.length(); }
+
+        const std::string pair = str.substr(pos, end - pos);
+        const size_t sep = pair.find(':');
+
+        if ((sep == std::string::npos) || (sep == 0)) { r = -(__LINE__); }
+        else
+        {
+            const int level = parseLevel(pair.substr(sep + 1));
+
+            if (level < 0) { r = -(__LINE__); }
+            else if (setLevel(pair.substr(0, sep).c_str(), level) != 0) { r = -(__LINE__); }
+        }
+
+        pos = end + 1;
+    }
+
+    return r;
+}
+
+void logging::setRateLimit(uint32_t burst, uint32_t period_ms, uint32_t dedup_ms)
+{
+    rateBurst = (period_ms > 0 ? burst : 0);
+    ratePeriod_ns = (uint64_t)period_ms * 1000000;
+    dedup_ns = (uint64_t)dedup_ms * 1000000;
+}
+
+
+
+void ___log_register(___log_module& module)
+{
+    std::lock_guard<std::mutex> lock(modulesMtx);
+
+    module.next = modules;
+    modules = &module;
+}
+
+void ___log_submit(___log_site& site, const char* format, const ___log_args& args)
+{
+    const uint64_t t_ns = util::monotonic_ns();
+    uint32_t identical = 0;
+    uint32_t limited = 0;
+
+    if (filter(site, args, t_ns, identical, limited))
+    {
+        ___log_args reportArgs;
+
+        if (identical)
+        {
+            buildReport(reportArgs, site, identical);
+            emit(identicalSite, identicalFormat, reportArgs, t_ns);
+        }
+
+        if (limited)
+        {
+            buildReport(reportArgs, site, limited);
+            emit(limitedSite, limitedFormat, reportArgs, t_ns);
+        }
+
+        emit(site, format, args, t_ns);
+    }
+
+    if (___log_binary.load(std::memory_order_relaxed) || !running)
+    {
+        uint64_t last = flush_ns.load(std::memory_order_relaxed);
+        if (((t_ns - last) >= flushPeriod_ns) && flush_ns.compare_exchange_strong(last, t_ns, std::memory_order_relaxed)) { flushPending(false, false); }
+    }
+}
+
+void ___log_flushPending() { flushPending(true, true); }
+
+
+
+Entry* claim(const char* format, uint64_t t_ns)
+{
+    Entry* entry = nullptr;
+
+    if (!running)
+    {
+        entry = &syncEntry;
+        entry->pos = 0;
+    }
+    else
+    {
+        // bounded MPSC queue, each slot has a sequence number which tells if it's free for the position
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+
+        while (!entry)
+        {
+            Entry* const slot = &ring[pos & (ringSize - 1)];
+            const size_t seq = slot->seq.load(std::memory_order_acquire);
+            const intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    entry = slot;
+                    entry->pos = pos;
+                }
+            }
+            else if (diff < 0) // full
+            {
+                if ((fullPolicy == logging::FP_block) && running && !stopRequest)
+                {
+                    cv.notify_one();
+                    std::this_thread::yield();
+                    pos = enqueuePos.load(std::memory_order_relaxed);
+                }
+                else
+                {
+                    ++droppedCnt;
+                    return nullptr;
+                }
+            }
+            else { pos = enqueuePos.load(std::memory_order_relaxed); }
+        }
+    }
+
+    entry->format = format;
+    entry->t_ns = t_ns;
+
+    return entry;
+}
+
+// `pendingMtx` has to be locked by the caller
+size_t collectPending(bool all, uint64_t now, PendingReport* reports, size_t maxCount)
+{
+    const uint64_t period = ratePeriod_ns.load(std::memory_order_relaxed);
+    const uint64_t dedup = dedup_ns.load(std::memory_order_relaxed);
+    size_t n = 0;
+
+    size_t i = 0;
+    while ((i < pendingSites.size()) && (n < maxCount))
+    {
+        ___log_site& site = *pendingSites[i];
+        uint32_t identical = 0;
+        uint32_t limited = 0;
+
+        // a busy call site is collected the next time
+        if (!tryLock(site))
+        {
+            ++i;
+            continue;
+        }
+
+        // not earlier than the call site itself would report them
+        if (all || ((now - site.last_ns) >= dedup))
+        {
+            identical = site.identicalCnt;
+            site.identicalCnt = 0;
+        }
+        if (all || ((now - site.window_ns) >= period))
+        {
+            limited = site.limitedCnt;
+            site.limitedCnt = 0;
+        }
+
+        const bool done = ((site.identicalCnt == 0) && (site.limitedCnt == 0));
+        if (done) { site.pending = false; }
+
+        unlock(site);
+
+        if (identical || limited)
+        {
+            reports[n].site = &site;
+            reports[n].identical = identical;
+            reports[n].limited = limited;
+            ++n;
+        }
+
+        if (done)
+        {
+            pendingSites[i] = pendingSites.back();
+            pendingSites.pop_back();
+        }
+        else { ++i; }
+    }
+
+    return n;
+}
+
+void emit(___log_site& site, const char* format, const ___log_args& args, uint64_t t_ns)
+{
+    if (___log_binary.load(std::memory_order_relaxed))
+    {
+        ___log_writeBinary(site, format, args, t_ns);
+        return;
+    }
+
+    Entry* const entry = claim(format, t_ns);
+    if (!entry) { return; }
+
+    entry->args.size = args.size;
+    entry->args.truncated = args.truncated;
+    std::memcpy(entry->args.payload, args.payload, args.size);
+
+    if (entry == &syncEntry)
+    {
+        char buffer[lineBufferSize];
+        const size_t n = formatEntry(*entry, buffer, sizeof(buffer));
+        term::writeLog(buffer, n);
+    }
+    else
+    {
+        entry->seq.store(entry->pos + 1, std::memory_order_release);
+
+        // notify_one() does not enter the kernel if the backend is not waiting
+        cv.notify_one();
+    }
+}
+
+
+
+void backendThread()
+{
+    static char outBuffer[outBufferSize];
+    uint32_t reportedDrops = 0;
+
+    while (true)
+    {
+        size_t outLen = 0;
+        bool empty = false;
+
+        // the lines are collected and written at once, to reduce the number of write() calls
+        while (!empty && ((outBufferSize - outLen) >= lineBufferSize))
+        {
+            Entry& entry = ring[dequeuePos & (ringSize - 1)];
+            const size_t seq = entry.seq.load(std::memory_order_acquire);
+
+            if (seq == (dequeuePos + 1))
+            {
+                outLen += formatEntry(entry, outBuffer + outLen, lineBufferSize);
+
+                entry.seq.store(dequeuePos + ringSize, std::memory_order_release);
+                ++dequeuePos;
+            }
+            else { empty = true; }
+        }
+
+        const uint32_t drops = droppedCnt;
+        if ((drops != reportedDrops) && ((outBufferSize - outLen) >= lineBufferSize))
+        {
+            Entry report;
+            report.format = "\033[93m" ___LOG_STR(LOG_MODULE_NAME) " <WRN> %u lines dropped\033[39m\n";
+            report.t_ns = util::monotonic_ns();
+            report.args.size = 0;
+            report.args.truncated = false;
+            report.args.put(drops - reportedDrops);
+
+            outLen += formatEntry(report, outBuffer + outLen, lineBufferSize);
+            reportedDrops = drops;
+        }
+
+        // the counts of call sites which went silent, and all of them on exit
+        if (empty && ((outBufferSize - outLen) >= lineBufferSize)) { outLen += reportPending(outBuffer + outLen, outBufferSize - outLen, stopRequest); }
+
+        if (outLen > 0) { term::writeLog(outBuffer, outLen); }
+
+        if (empty)
+        {
+            if (stopRequest) { break; }
+
+            // the timeout covers a notification between the check and the wait
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait_for(lock, std::chrono::milliseconds(10));
+        }
+    }
+
+    running = false;
+}
+
+bool filter(___log_site& site, const ___log_args& args, uint64_t t_ns, uint32_t& identical, uint32_t& limited)
+{
+    const uint32_t burst = rateBurst.load(std::memory_order_relaxed);
+    const uint64_t period = ratePeriod_ns.load(std::memory_order_relaxed);
+    const uint64_t dedup = ((site.level <= LOG_LEVEL_WRN) ? dedup_ns.load(std::memory_order_relaxed) : 0);
+
+    if ((burst == 0) && (dedup == 0)) { return true; }
+
+    const uint32_t hash = (dedup ? hashArgs(args) : 0);
+    bool pass = true;
+    bool addPending = false;
+
+    // a thread which spins on the lock would starve a lower priority holder, the line is dropped instead
+    if (!tryLock(site))
+    {
+        ++droppedCnt;
+        return false;
+    }
+
+    if (dedup && site.lastValid && (hash == site.lastHash) && ((t_ns - site.last_ns) < dedup))
+    {
+        ++site.identicalCnt;
+        pass = false;
+    }
+    else if (burst)
+    {
+        if ((t_ns - site.window_ns) >= period)
+        {
+            site.window_ns = t_ns;
+            site.windowCount = 0;
+        }
+
+        if (site.windowCount >= burst)
+        {
+            ++site.limitedCnt;
+            pass = false;
+        }
+        else { ++site.windowCount; }
+    }
+
+    if (pass)
+    {
+        identical = site.identicalCnt;
+        limited = site.limitedCnt;
+        site.identicalCnt = 0;
+        site.limitedCnt = 0;
+        site.last_ns = t_ns;
+        site.lastHash = hash;
+        site.lastValid = true;
+    }
+
+    else if (!site.pending)
+    {
+        site.pending = true;
+        addPending = true;
+    }
+
+    unlock(site);
+
+    if (addPending)
+    {
+        std::lock_guard<std::mutex> lg(pendingMtx);
+        pendingSites.push_back(&site);
+    }
+
+    return pass;
+}
+
+// emits the reports like the lines of the call sites, so to the binary sink or synchronously if the backend is not running
+void flushPending(bool all, bool wait)
+{
+    const uint64_t now = util::monotonic_ns();
+    PendingReport reports[8];
+    size_t n;
+
+    do {
+        {
+            std::unique_lock<std::mutex> lg(pendingMtx, std::defer_lock);
+
+            if (wait) { lg.lock(); }
+            else if (!lg.try_lock()) { return; }
+
+            n = collectPending(all, now, reports, SIZEOF_ARRAY(reports));
+        }
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            ___log_args args;
+
+            if (reports[i].identical)
+            {
+                buildReport(args, *reports[i].site, reports[i].identical);
+                emit(identicalSite, identicalFormat, args, now);
+            }
+
+            if (reports[i].limited)
+            {
+                buildReport(args, *reports[i].site, reports[i].limited);
+                emit(limitedSite, limitedFormat, args, now);
+            }
+        }
+    }
+    while (n == SIZEOF_ARRAY(reports));
+}
+
+size_t formatEntry(const Entry& entry, char* buffer, size_t size)
+{
+    size_t len = 0;
+
+    char ts[40];
+    util::format_timestamp(ts, sizeof(ts), util::TSF_iso8601_local, util::TSR_ms, util::monotonic_to_wall_ns(entry.t_ns));
+
+    const int n = std::snprintf(buffer, size, ___LOG_CSI_EL "[%s] ", ts);
+    if (n > 0) { len = ((size_t)n < size ? (size_t)n : size - 1); }
+
+    len += logging::formatMessage(buffer + len, size - len, entry.format, entry.args.payload, entry.args.size);
+
+    return len;
+}
+
+uint32_t hashArgs(const ___log_args& args)
+{
+    uint64_t hash = 0xcbf29ce484222325ull ^ args.size;
+    size_t i = 0;
+
+    for (; (i + sizeof(uint64_t)) <= args.size; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        std::memcpy(&word, args.payload + i, sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3ull;
+        hash ^= hash >> 29;
+    }
+
+    if (i < args.size)
+    {
+        uint64_t word = 0;
+        std::memcpy(&word, args.payload + i, args.size - i);
+        hash = (hash ^ word) * 0x100000001b3ull;
+        hash ^= hash >> 29;
+    }
+
+    return (uint32_t)(hash ^ (hash >> 32));
+}
+
+void buildReport(___log_args& args, const ___log_site& reported, uint32_t count)
+{
+    const char* file = std::strrchr(reported.file, '/');
+    file = (file ? file + 1 : reported.file);
+
+    args.size = 0;
+    args.truncated = false;
+    args.put(reported.module);
+    args.put(count);
+    args.put(file);
+    args.put(reported.line);
+}
+
+bool iequals(const char* a, const char* b)
+{
+    while (*a && (std::tolower((unsigned char)(*a)) == std::tolower((unsigned char)(*b))))
+    {
+        ++a;
+        ++b;
+    }
+
+    return (*a == *b);
+}
+
+void initRing()
+{
+    for (size_t i = 0; i < ringSize; ++i) { ring[i].seq.store(i, std::memory_order_relaxed); }
+
+    enqueuePos.store(0, std::memory_order_relaxed);
+    dequeuePos = 0;
+}
+
+int parseLevel(const std::string& str)
+{
+    static const char* const names[] = { "off", "err", "wrn", "inf", "dbg" };
+
+    for (int i = 0; i < (int)SIZEOF_ARRAY(names); ++i)
+    {
+        if (iequals(str.c_str(), names[i])) { return i; }
+    }
+
+    if ((str.length() == 1) && (str[0] >= '0') && (str[0] <= '4')) { return str[0] - '0'; }
+
+    return -1;
+}
+
+size_t reportPending(char* buffer, size_t size, bool all)
+{
+    const uint64_t now = util::monotonic_ns();
+    PendingReport reports[outBufferSize / (2 * lineBufferSize)];
+    size_t n;
+    size_t len = 0;
+
+    {
+        std::lock_guard<std::mutex> lg(pendingMtx);
+
+        size_t maxCount = size / (2 * lineBufferSize);
+        if (maxCount > SIZEOF_ARRAY(reports)) { maxCount = SIZEOF_ARRAY(reports); }
+
+        n = collectPending(all, now, reports, maxCount);
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        Entry report;
+        report.t_ns = now;
+
+        if (reports[i].identical)
+        {
+            report.format = identicalFormat;
+            buildReport(report.args, *reports[i].site, reports[i].identical);
+            len += formatEntry(report, buffer + len, lineBufferSize);
+        }
+
+        if (reports[i].limited)
+        {
+            report.format = limitedFormat;
+            buildReport(report.args, *reports[i].site, reports[i].limited);
+            len += formatEntry(report, buffer + len, lineBufferSize);
+        }
+    }
+
+    return len;
+}
+
+// the critical section is short, the lock is only contended if several threads log through the same call site
+bool tryLock(___log_site& site) { return !site.busy.exchange(true, std::memory_order_acquire); }
+
+void unlock(___log_site& site) { site.busy.store(false, std::memory_order_release); }
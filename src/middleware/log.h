@@ -6,6 +6,8 @@ copyright       MIT - Copyright (c) 2024 Oliver Blaser
 #ifndef IG_MIDDLEWARE_LOG_H
 #define IG_MIDDLEWARE_LOG_H
 
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 
 
@@ -72,39 +74,299 @@ __pragma(message(__PRAGMA_LOC__ ": warning: \"CONFIG_LOG_LEVEL is not defined, d
 
 
 
-// config can limit log level
+// config can limit the initial log level
 #if (CONFIG_LOG_LEVEL < LOG_MODULE_LEVEL)
 #undef LOG_MODULE_LEVEL
 #define LOG_MODULE_LEVEL CONFIG_LOG_LEVEL
 #endif
 
+// calls above this level are not compiled in, up to this level they can be enabled at runtime
+#ifndef CONFIG_LOG_LEVEL_MAX
+#define CONFIG_LOG_LEVEL_MAX LOG_LEVEL_DBG
+#endif
+
 
 
+#include "middleware/log-format.h"
 #include "middleware/util.h"
 
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+namespace logging {
+
+enum FULL_POLICY
+{
+    FP_drop = 0, // the line is dropped and counted, the caller never waits
+    FP_block,    // the caller waits until the backend thread has freed a slot
+};
+
+/**
+ * @brief Starts the backend thread.
+ *
+ * The `LOG_*` macros only copy the format string pointer and the arguments into a preallocated ring, formatting and
+ * writing is done by the backend thread. Before `logging::start()` and after `logging::stop()` the lines are formatted
+ * and written by the caller.
+ *
+ * @param policy Behaviour if the ring is full (`logging::FULL_POLICY`)
+ * @return 0 on success
+ */
+int start(int policy);
+
+/**
+ * @brief Writes the pending lines and stops the backend thread.
+ */
+void stop();
+
+/**
+ * @return Number of lines dropped because the ring was full
+ */
+uint32_t dropped();
+
+/**
+ * @brief Switches the `LOG_*` macros to the binary sink.
+ *
+ * Instead of text, each call writes only its call site ID, the monotonic timestamp and the captured arguments into a
+ * memory mapped file. The format string of a call site is written once, with its first call. The file is converted to
+ * text by the `rpihal-log-decode` tool. If the file is full, further lines are dropped and counted.
+ *
+ * @param filename File to create, an existing file is overwritten
+ * @param size Maximum file size in bytes
+ * @return 0 on success
+ */
+int startBinary(const char* filename, size_t size);
+
+/**
+ * @brief Stops the binary sink, the file is truncated to the written size.
+ *
+ * The other threads which log have to be stopped before.
+ */
+void stopBinary();
+
+/**
+ * @brief Sets the log level of a module at runtime.
+ *
+ * The initial level of a module is `LOG_MODULE_LEVEL` (limited by `CONFIG_LOG_LEVEL`). Levels up to
+ * `CONFIG_LOG_LEVEL_MAX` can be enabled, the calls above it are not compiled in.
+ *
+ * @param module Module name (`LOG_MODULE_NAME`, case insensitive) or `*` for all modules
+ * @param level `LOG_LEVEL_*`
+ * @return 0 on success
+ */
+int setLevel(const char* module, int level);
+
+/**
+ * @brief Sets the levels of a comma separated list of `MODULE:LEVEL` pairs.
+ *
+ * The level is a number or one of `off`, `err`, `wrn`, `inf`, `dbg`. The pairs are applied from left to right, e.g.
+ * `*:wrn,ADC:dbg`.
+ *
+ * @return 0 on success
+ */
+int setLevels(const char* spec);
+
+/**
+ * @brief Configures the rate limit and the deduplication, which are applied per call site.
+ *
+ * A call site logs at most `burst` lines per `period_ms`. An error or warning which is identical to the previous line
+ * of its call site (same arguments) is logged again only after `dedup_ms`. The suppressed lines are counted and
+ * reported before the next line of the call site which is logged, or by the backend thread once the period has expired.
+ * 0 disables the respective limit.
+ *
+ * Default: 20 lines per 1000 ms, 10000 ms deduplication
+ */
+void setRateLimit(uint32_t burst, uint32_t period_ms, uint32_t dedup_ms);
+
+} // namespace logging
+
+// internals of the LOG_* macros
+
+constexpr uint32_t ___log_fnv1a(const char* str, uint32_t hash = 2166136261u) { return (*str == 0 ? hash : ___log_fnv1a(str + 1, (hash ^ (uint8_t)(*str)) * 16777619u)); }
+
+// compile time ID of a call site, the format is included because there can be more than one call per line
+constexpr uint32_t ___log_siteId(const char* file, int line, const char* format) { return ___log_fnv1a(format, ___log_fnv1a(file, 2166136261u ^ ((uint32_t)line * 2654435761u))); }
+
+struct ___log_module
+{
+    constexpr ___log_module(const char* name_, int level_)
+        : name(name_), level(level_), next(nullptr)
+    {}
+
+    const char* const name;
+    std::atomic<int> level;
+    ___log_module* next; // registry
+};
+
+void ___log_register(___log_module& module);
+
+struct ___log_registrar
+{
+    explicit ___log_registrar(___log_module& module) { ___log_register(module); }
+};
+
+// one per translation unit, the level is constant initialised so it's valid before the registration
+namespace {
+___log_module ___log_thisModule(___LOG_STR(LOG_MODULE_NAME), LOG_MODULE_LEVEL);
+const ___log_registrar ___log_thisModuleRegistrar(___log_thisModule);
+} // namespace
+
+struct ___log_site
+{
+    constexpr ___log_site(uint32_t id_, const char* file_, int line_, const char* module_, int level_)
+        : id(id_),
+          file(file_),
+          line(line_),
+          module(module_),
+          level(level_),
+          defined(0),
+          busy(false),
+          window_ns(0),
+          windowCount(0),
+          last_ns(0),
+          lastHash(0),
+          lastValid(false),
+          identicalCnt(0),
+          limitedCnt(0),
+          pending(false)
+    {}
+
+    const uint32_t id;
+    const char* const file;
+    const int line;
+    const char* const module;
+    const int level;
+    std::atomic<uint32_t> defined; // session of the binary sink to which the definition record has been written
+
+    // rate limit and deduplication, protected by `busy`
+    std::atomic<bool> busy;
+    uint64_t window_ns;
+    uint32_t windowCount;
+    uint64_t last_ns; // last line which has been logged
+    uint32_t lastHash;
+    bool lastValid;
+    uint32_t identicalCnt; // suppressed since the last line which has been logged
+    uint32_t limitedCnt;
+    bool pending; // the backend reports the counts if the call site stays silent
+};
+
+struct ___log_args
+{
+    static constexpr size_t payloadSize = 224;
+
+    uint16_t size;  // used bytes of the payload
+    bool truncated; // not all arguments did fit into the payload
+    uint8_t payload[payloadSize];
+
+    void put(const char* str)
+    {
+        if (!str) { str = "(null)"; }
+
+        size_t len = std::strlen(str);
+        if (len > 255) { len = 255; }
+
+        // strings are truncated to the remaining space
+        if ((size + 2u) > payloadSize)
+        {
+            truncated = true;
+            return;
+        }
+        if ((size + 2u + len) > payloadSize) { len = payloadSize - size - 2u; }
+
+        payload[size++] = logging::AT_str;
+        payload[size++] = (uint8_t)len;
+        std::memcpy(payload + size, str, len);
+        size += (uint16_t)len;
+    }
+
+    void put(char* str) { put((const char*)str); }
+
+    template <typename T> void put(const T& value)
+    {
+        if constexpr (std::is_floating_point<T>::value) { m_put(logging::AT_double, (double)value); }
+        else if constexpr (std::is_pointer<T>::value) { m_put(logging::AT_ptr, (uint64_t)(uintptr_t)(const void*)value); }
+        else if constexpr (std::is_enum<T>::value) { put((typename std::underlying_type<T>::type)value); }
+        else if constexpr (std::is_signed<T>::value) { m_put(logging::AT_int, (int64_t)value); }
+        else { m_put(logging::AT_uint, (uint64_t)value); }
+    }
+
+private:
+    template <typename V> void m_put(uint8_t type, V value)
+    {
+        if ((size + 1u + sizeof(V)) > payloadSize)
+        {
+            truncated = true;
+            return;
+        }
+
+        payload[size++] = type;
+        std::memcpy(payload + size, &value, sizeof(V));
+        size += (uint16_t)sizeof(V);
+    }
+};
+
+extern std::atomic<bool> ___log_binary;
+
+/**
+ * @brief Applies the rate limit and passes the line to the backend ring or the binary sink.
+ */
+void ___log_submit(___log_site& site, const char* format, const ___log_args& args);
+
+void ___log_writeBinary(___log_site& site, const char* format, const ___log_args& args, uint64_t t_ns);
+
+/**
+ * @brief Reports the counts of all call sites which are suppressed by the rate limit or the deduplication.
+ */
+void ___log_flushPending();
+
+template <typename... Args> inline void ___log_async(___log_site& site, const char* format, const Args&... args)
+{
+    ___log_args a;
+    a.size = 0;
+    a.truncated = false;
+    (a.put(args), ...);
+    ___log_submit(site, format, a);
+}
+
+#define ___LOG_FIRST(first, ...) first
+
+// the dead printf() call keeps the compile time format check, the site is constant initialised (no guard). A disabled
+// level costs one relaxed load and one branch.
+#define ___LOG_ASYNC(lvl, ...)                                                                                    \
+    do {                                                                                                          \
+        if (0) { std::printf(__VA_ARGS__); }                                                                      \
+        if (___log_thisModule.level.load(std::memory_order_relaxed) >= (lvl))                                     \
+        {                                                                                                         \
+            static constexpr uint32_t ___log_id = ___log_siteId(__FILE__, __LINE__, ___LOG_FIRST(__VA_ARGS__));   \
+            static ___log_site ___log_siteObj(___log_id, __FILE__, __LINE__, ___LOG_STR(LOG_MODULE_NAME), (lvl)); \
+            ___log_async(___log_siteObj, __VA_ARGS__);                                                            \
+        }                                                                                                         \
+    }                                                                                                             \
+    while (0)
+
 // clang-format off
-#define LOG_ERR(msg, ...) std::printf(___LOG_CSI_EL "[%s] " "\033[91m" ___LOG_STR(LOG_MODULE_NAME) " <ERR> " msg "\033[39m" "\n", util::t_to_iso8601_local(std::time(nullptr)).c_str() ___LOG_OPT_VA_ARGS(__VA_ARGS__))
-#define LOG_WRN(msg, ...) std::printf(___LOG_CSI_EL "[%s] " "\033[93m" ___LOG_STR(LOG_MODULE_NAME) " <WRN> " msg "\033[39m" "\n", util::t_to_iso8601_local(std::time(nullptr)).c_str() ___LOG_OPT_VA_ARGS(__VA_ARGS__))
-#define LOG_INF(msg, ...) std::printf(___LOG_CSI_EL "[%s] " "\033[39m" ___LOG_STR(LOG_MODULE_NAME) " <INF> " msg "\033[39m" "\n", util::t_to_iso8601_local(std::time(nullptr)).c_str() ___LOG_OPT_VA_ARGS(__VA_ARGS__))
-//#define LOG_DBG(msg, ...) std::printf(___LOG_CSI_EL "[%s] " "\033[39m" ___LOG_STR(LOG_MODULE_NAME) " <DBG> " msg "\033[39m" "\n", util::t_to_iso8601_local(std::time(nullptr)).c_str() ___LOG_OPT_VA_ARGS(__VA_ARGS__))
-#define LOG_DBG(msg, ...) std::printf(___LOG_CSI_EL "[%s] " "\033[39m" ___LOG_STR(LOG_MODULE_NAME) " <DBG> \033[90m%s():%i\033[39m " msg "\033[39m" "\n", util::t_to_iso8601_local(std::time(nullptr)).c_str(), __func__, (int)(__LINE__) ___LOG_OPT_VA_ARGS(__VA_ARGS__))
+#define LOG_ERR(msg, ...) ___LOG_ASYNC(LOG_LEVEL_ERR, "\033[91m" ___LOG_STR(LOG_MODULE_NAME) " <ERR> " msg "\033[39m" "\n" ___LOG_OPT_VA_ARGS(__VA_ARGS__))
+#define LOG_WRN(msg, ...) ___LOG_ASYNC(LOG_LEVEL_WRN, "\033[93m" ___LOG_STR(LOG_MODULE_NAME) " <WRN> " msg "\033[39m" "\n" ___LOG_OPT_VA_ARGS(__VA_ARGS__))
+#define LOG_INF(msg, ...) ___LOG_ASYNC(LOG_LEVEL_INF, "\033[39m" ___LOG_STR(LOG_MODULE_NAME) " <INF> " msg "\033[39m" "\n" ___LOG_OPT_VA_ARGS(__VA_ARGS__))
+//#define LOG_DBG(msg, ...) ___LOG_ASYNC(LOG_LEVEL_DBG, "\033[39m" ___LOG_STR(LOG_MODULE_NAME) " <DBG> " msg "\033[39m" "\n" ___LOG_OPT_VA_ARGS(__VA_ARGS__))
+#define LOG_DBG(msg, ...) ___LOG_ASYNC(LOG_LEVEL_DBG, "\033[39m" ___LOG_STR(LOG_MODULE_NAME) " <DBG> \033[90m%s():%i\033[39m " msg "\033[39m" "\n", __func__, (int)(__LINE__) ___LOG_OPT_VA_ARGS(__VA_ARGS__))
 // clang-format on
 
 
 
-#if (LOG_MODULE_LEVEL < LOG_LEVEL_DBG)
+#if (CONFIG_LOG_LEVEL_MAX < LOG_LEVEL_DBG)
 #undef LOG_DBG
 #define LOG_DBG(...) (void)0
 #endif
-#if (LOG_MODULE_LEVEL < LOG_LEVEL_INF)
+#if (CONFIG_LOG_LEVEL_MAX < LOG_LEVEL_INF)
 #undef LOG_INF
 #define LOG_INF(...) (void)0
 #endif
-#if (LOG_MODULE_LEVEL < LOG_LEVEL_WRN)
+#if (CONFIG_LOG_LEVEL_MAX < LOG_LEVEL_WRN)
 #undef LOG_WRN
 #define LOG_WRN(...) (void)0
 #endif
-#if (LOG_MODULE_LEVEL < LOG_LEVEL_ERR)
+#if (CONFIG_LOG_LEVEL_MAX < LOG_LEVEL_ERR)
 #undef LOG_ERR
 #define LOG_ERR(...) (void)0
 #endif
@@ -0,0 +1,155 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <cerrno>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "middleware/histogram.h"
+#include "middleware/term.h"
+#include "perf.h"
+
+#include <omw/defs.h>
+
+
+#define LOG_MODULE_LEVEL LOG_LEVEL_INF
+#define LOG_MODULE_NAME  PERF
+#include "middleware/log.h"
+
+
+// recorded from several threads (main loop, acquisition workers, real-time threads), so it has to be lock free
+static util::AtomicHistogram histograms[perf::P__end_];
+static volatile std::sig_atomic_t printRequest = 0;
+
+static const char* probeName(int probe);
+
+#ifndef OMW_PLAT_WIN
+static void signalHandler(int sig);
+#endif
+
+
+
+int perf::init()
+{
+#ifndef OMW_PLAT_WIN
+
+    struct sigaction sa;
+    std::memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = signalHandler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = 0; // no SA_RESTART, the event loop has to wake up
+
+    if (sigaction(SIGUSR1, &sa, nullptr) != 0)
+    {
+        LOG_ERR("failed to install signal handler, errno: %i %s", errno, std::strerror(errno));
+        return -(__LINE__);
+    }
+
+#endif // OMW_PLAT_WIN
+
+    return 0;
+}
+
+void perf::record(int probe, uint64_t t_ns)
+{
+    if ((probe >= 0) && (probe < P__end_)) { histograms[probe].record(t_ns); }
+}
+
+void perf::merge(int probe, const util::Histogram& histogram)
+{
+    if ((probe >= 0) && (probe < P__end_)) { histograms[probe].add(histogram); }
+}
+
+void perf::print()
+{
+    // the table is written at once, so it's not torn apart by log lines of other threads
+    char buffer[(P__end_ + 1) * 96];
+    size_t len = 0;
+
+    static util::Histogram h; // only called from the main loop
+
+    len += std::snprintf(buffer + len, sizeof(buffer) - len, ___LOG_CSI_EL "%-16s %10s %10s %10s %10s %10s  [us]\n", "probe", "count", "p50", "p99", "p99.9",
+                         "max");
+
+    for (int i = 0; (i < P__end_) && (len < sizeof(buffer)); ++i)
+    {
+        histograms[i].snapshot(h);
+
+        if (h.count() == 0) { continue; }
+
+        len += std::snprintf(buffer + len, sizeof(buffer) - len, "%-16s %10llu %10.1f %10.1f %10.1f %10.1f\n", probeName(i), (unsigned long long)h.count(),
+                             (double)h.percentile(50) / 1e3, (double)h.percentile(99) / 1e3, (double)h.percentile(99.9) / 1e3, (double)h.max() / 1e3);
+    }
+
+    if (len > sizeof(buffer)) { len = sizeof(buffer) - 1; }
+
+    term::writeLog(buffer, len);
+}
+
+bool perf::printRequested()
+{
+    const bool r = (printRequest != 0);
+    printRequest = 0;
+    return r;
+}
+
+
+
+const char* probeName(int probe)
+{
+    const char* str;
+
+    switch (probe)
+    {
+    case perf::P_loopPeriod:
+        str = "loop period";
+        break;
+
+    case perf::P_loopBusy:
+        str = "loop busy";
+        break;
+
+    case perf::P_wakeupLatency:
+        str = "wakeup latency";
+        break;
+
+    case perf::P_gpioTask:
+        str = "gpio::task()";
+        break;
+
+    case perf::P_appTask:
+        str = "app::task()";
+        break;
+
+    case perf::P_adcRead:
+        str = "adc::read()";
+        break;
+
+    case perf::P_cpuTemp:
+        str = "CPU temp";
+        break;
+
+    case perf::P_pcbTemp:
+        str = "temp::get()";
+        break;
+
+    case perf::P_pwmLatency:
+        str = "PWM latency";
+        break;
+
+    default:
+        str = "?";
+        break;
+    }
+
+    return str;
+}
+
+#ifndef OMW_PLAT_WIN
+void signalHandler(int sig) { printRequest = 1; }
+#endif
@@ -0,0 +1,90 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_PERF_H
+#define IG_MIDDLEWARE_PERF_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "middleware/histogram.h"
+#include "middleware/util.h"
+
+
+namespace perf {
+
+enum PROBE
+{
+    P_loopPeriod = 0, // time between two loop iterations
+    P_loopBusy,       // time spent in the loop iteration
+    P_wakeupLatency,  // time between the requested deadline and the actual wakeup
+    P_gpioTask,
+    P_appTask,
+    P_adcRead,
+    P_cpuTemp,
+    P_pcbTemp,
+    P_pwmLatency, // time between the scheduled and the actual PWM switching, merged when the PWM is stopped
+
+    P__end_
+};
+
+/**
+ * @brief Installs the signal handler (`SIGUSR1`) to request printing the statistics.
+ *
+ * @return 0 on success
+ */
+int init();
+
+/**
+ * @brief Records a duration, allocation free and lock free, may be called from any thread.
+ *
+ * @param probe Probe ID (`perf::PROBE`)
+ * @param t_ns Duration in ns
+ */
+void record(int probe, uint64_t t_ns);
+
+/**
+ * @brief Adds all values of a histogram which was recorded locally, lock free.
+ *
+ * @param probe Probe ID (`perf::PROBE`)
+ */
+void merge(int probe, const util::Histogram& histogram);
+
+/**
+ * @brief Prints count, p50, p99, p99.9 and max of all probes which have recorded values.
+ */
+void print();
+
+/**
+ * @return `true` once after `SIGUSR1` has been received
+ */
+bool printRequested();
+
+static inline uint64_t now() { return util::monotonic_ns(); }
+
+class Probe
+{
+public:
+    Probe() = delete;
+
+    explicit Probe(int probe)
+        : m_probe(probe), m_t0(perf::now())
+    {}
+
+    virtual ~Probe() { perf::record(m_probe, perf::now() - m_t0); }
+
+private:
+    int m_probe;
+    uint64_t m_t0;
+
+    Probe(const Probe& other) = delete;
+    Probe(const Probe&& other) = delete;
+    Probe& operator=(const Probe& other);
+};
+
+} // namespace perf
+
+
+#endif // IG_MIDDLEWARE_PERF_H
@@ -0,0 +1,273 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include "gpio-event.h"
+#include "middleware/seqlock.h"
+#include "middleware/util.h"
+#include "pulse.h"
+
+#include <rpihal/gpio.h>
+
+#ifndef RPIHAL_EMU
+#include <linux/gpio.h>
+#include <poll.h>
+#include <unistd.h>
+#endif // RPIHAL_EMU
+
+
+#define LOG_MODULE_LEVEL LOG_LEVEL_INF
+#define LOG_MODULE_NAME  PULSE
+#include "middleware/log.h"
+
+
+#define EVENT_BUFFER_SIZE (1024) // kernel buffer, covers ~10ms at 100kHz
+
+
+#ifndef RPIHAL_EMU
+static_assert(sizeof(pulse::LineEvent) == sizeof(struct gpio_v2_line_event), "pulse::LineEvent does not match the kernel ABI");
+static_assert(offsetof(pulse::LineEvent, timestamp_ns) == offsetof(struct gpio_v2_line_event, timestamp_ns), "pulse::LineEvent does not match the kernel ABI");
+static_assert(offsetof(pulse::LineEvent, offset) == offsetof(struct gpio_v2_line_event, offset), "pulse::LineEvent does not match the kernel ABI");
+static_assert(offsetof(pulse::LineEvent, line_seqno) == offsetof(struct gpio_v2_line_event, line_seqno), "pulse::LineEvent does not match the kernel ABI");
+#endif // RPIHAL_EMU
+
+
+
+// only accessed by the counter thread while it is running
+static pulse::Counter counters[64];
+static uint32_t lostCnt[64];
+
+static util::Seqlock<pulse::Snapshot> snapshots[64];
+static pulse::Config config = pulse::defaultConfig();
+
+static std::thread thread;
+static std::atomic<bool> run(false);
+
+static void publish(uint64_t now_ns);
+static void samplingThread();
+
+#ifndef RPIHAL_EMU
+static int linefd = -1;
+
+static void eventThread();
+#endif // RPIHAL_EMU
+
+
+
+int pulse::start(const Config& cfg)
+{
+    if (run) { return 0; }
+
+    if ((cfg.pins == 0) || (cfg.window_ms == 0) || ((cfg.edges & E_both) == 0))
+    {
+        LOG_ERR("invalid config");
+        return -(__LINE__);
+    }
+
+    config = cfg;
+
+    for (size_t i = 0; i < SIZEOF_ARRAY(counters); ++i)
+    {
+        counters[i].reset();
+        lostCnt[i] = 0;
+    }
+
+#ifndef RPIHAL_EMU
+    linefd = gpioEvent::requestLines(cfg.pins, (cfg.edges & E_rising), (cfg.edges & E_falling), EVENT_BUFFER_SIZE);
+
+    if (linefd >= 0)
+    {
+        run = true;
+        thread = std::thread(eventThread);
+        return 0;
+    }
+
+    LOG_WRN("GPIO character device is not available, falling back to sampling the pins every %ius", (int)samplePeriod_us);
+#endif // RPIHAL_EMU
+
+    run = true;
+    thread = std::thread(samplingThread);
+
+    return 0;
+}
+
+void pulse::stop()
+{
+    if (!run) { return; }
+
+    run = false;
+    if (thread.joinable()) { thread.join(); }
+
+#ifndef RPIHAL_EMU
+    if (linefd >= 0)
+    {
+        close(linefd);
+        linefd = -1;
+    }
+#endif // RPIHAL_EMU
+
+    for (int pin = 0; pin < 64; ++pin)
+    {
+        Snapshot snapshot;
+
+        if (get(pin, snapshot))
+        {
+            LOG_INF("GPIO%i: %llu edges, %u lost, %.3fHz", pin, (unsigned long long)snapshot.count, snapshot.lost, snapshot.frequency_Hz);
+        }
+    }
+}
+
+bool pulse::running() { return run; }
+
+bool pulse::get(int pin, Snapshot& snapshot)
+{
+    if ((pin < 0) || (pin >= 64) || ((config.pins & RPIHAL_GPIO_BIT(pin)) == 0)) { return false; }
+
+    return (snapshots[pin].read(snapshot) != 0);
+}
+
+void pulse::decode(const LineEvent* events, size_t count, Counter* counters, uint32_t* lastSeqno, uint32_t* lost)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const LineEvent& ev = events[i];
+        const uint32_t pin = ev.offset;
+
+        if (pin >= 64) { continue; }
+
+        // the line sequence number has gaps if the kernel buffer overflowed
+        if ((lastSeqno[pin] != 0) && ((ev.line_seqno - lastSeqno[pin]) > 1)) { lost[pin] += (ev.line_seqno - lastSeqno[pin] - 1); }
+        lastSeqno[pin] = ev.line_seqno;
+
+        counters[pin].edge(ev.timestamp_ns);
+    }
+}
+
+
+
+void publish(uint64_t now_ns)
+{
+    const unsigned edgesPerPeriod = ((config.edges & pulse::E_both) == pulse::E_both ? 2 : 1);
+
+    for (int pin = 0; pin < 64; ++pin)
+    {
+        if (config.pins & RPIHAL_GPIO_BIT(pin))
+        {
+            pulse::Snapshot snapshot;
+            counters[pin].window(now_ns, edgesPerPeriod, snapshot);
+            snapshot.lost = lostCnt[pin];
+
+            snapshots[pin].write(snapshot);
+        }
+    }
+}
+
+
+
+void samplingThread()
+{
+    const uint64_t pins = config.pins;
+    const uint64_t rising = ((config.edges & pulse::E_rising) ? UINT64_MAX : 0);
+    const uint64_t falling = ((config.edges & pulse::E_falling) ? UINT64_MAX : 0);
+    const uint64_t window_ns = (uint64_t)config.window_ms * 1000000;
+
+    uint64_t old = RPIHAL_GPIO_read64() & pins;
+    uint64_t next = util::monotonic_ns();
+    uint64_t windowEnd = next + window_ns;
+
+    while (run)
+    {
+        // absolute wakeup times, so that the period does not drift by the loop duration
+        next += (uint64_t)pulse::samplePeriod_us * 1000;
+        util::sleep_until(next);
+
+        const uint64_t levels = RPIHAL_GPIO_read64() & pins;
+        const uint64_t changed = ((levels & ~old & rising) | (~levels & old & falling));
+        old = levels;
+
+        if (changed)
+        {
+            const uint64_t t_ns = util::monotonic_ns();
+
+            for (int pin = 0; pin < 64; ++pin)
+            {
+                if (changed & RPIHAL_GPIO_BIT(pin)) { counters[pin].edge(t_ns); }
+            }
+        }
+
+        if (next >= windowEnd)
+        {
+            publish(next);
+            windowEnd += window_ns;
+        }
+    }
+}
+
+
+
+#ifndef RPIHAL_EMU
+
+void eventThread()
+{
+    const uint64_t window_ns = (uint64_t)config.window_ms * 1000000;
+
+    uint32_t lastSeqno[64] = {};
+    uint64_t windowEnd = util::monotonic_ns() + window_ns;
+
+    struct pollfd pfd;
+    pfd.fd = linefd;
+    pfd.events = POLLIN;
+
+    while (run)
+    {
+        uint64_t now = util::monotonic_ns();
+
+        if (now >= windowEnd)
+        {
+            publish(now);
+            windowEnd += window_ns;
+            if (windowEnd <= now) { windowEnd = now + window_ns; }
+        }
+
+        // the timeout is limited, so that `pulse::stop()` does not have to wait for a whole window
+        int timeout_ms = (int)((windowEnd - now + 999999) / 1000000);
+        if (timeout_ms > 100) { timeout_ms = 100; }
+
+        pfd.revents = 0;
+        const int res = poll(&pfd, 1, timeout_ms);
+
+        if (res < 0)
+        {
+            if (errno == EINTR) { continue; }
+
+            LOG_ERR("poll() failed, errno: %i %s", errno, std::strerror(errno));
+            break;
+        }
+
+        if (res == 0) { continue; }
+
+        // read in batches, one syscall per 64 edges
+        constexpr size_t n = 64;
+        pulse::LineEvent events[n];
+        ssize_t nBytes;
+
+        while ((nBytes = read(linefd, events, sizeof(events))) > 0)
+        {
+            const size_t cnt = (size_t)nBytes / sizeof(events[0]);
+
+            pulse::decode(events, cnt, counters, lastSeqno, lostCnt);
+
+            if (cnt < n) { break; }
+        }
+    }
+}
+
+#endif // RPIHAL_EMU
@@ -0,0 +1,185 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_PULSE_H
+#define IG_MIDDLEWARE_PULSE_H
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace pulse {
+
+// sampling period if the GPIO character device is not available
+constexpr uint32_t samplePeriod_us = 250;
+
+enum EDGE
+{
+    E_rising = 0x01,
+    E_falling = 0x02,
+    E_both = (E_rising | E_falling),
+};
+
+struct Config
+{
+    uint64_t pins;      // bit mask of the counted pins (`RPIHAL_GPIO_BIT()`)
+    uint32_t window_ms; // the frequency is computed and published once per window
+    int edges;          // counted edges (`pulse::EDGE`)
+};
+
+struct Snapshot
+{
+    uint64_t count;      // counted edges since start
+    uint32_t lost;       // edges lost because the kernel buffer was full
+    double frequency_Hz; // signal frequency, 0 if there was no edge in the last two windows
+    double period_us;    // 0 if the frequency is 0
+    uint64_t t_ns;       // end of the window (`util::monotonic_ns()`)
+};
+
+static inline Config defaultConfig()
+{
+    Config cfg;
+    cfg.pins = 0;
+    cfg.window_ms = 1000;
+    cfg.edges = E_rising;
+    return cfg;
+}
+
+/**
+ * @brief Counts the edges of one pin and computes the frequency per window.
+ *
+ * The frequency is measured reciprocally, the number of edges divided by the time between the last edge of the window
+ * and the last edge before the window. So the resolution depends on the timestamps, not on the window length.
+ */
+class Counter
+{
+public:
+    Counter() { reset(); }
+
+    virtual ~Counter() {}
+
+    void reset()
+    {
+        m_count = 0;
+        m_windowCount = 0;
+        m_first_ns = 0;
+        m_last_ns = 0;
+        m_ref_ns = 0;
+        m_refValid = false;
+        m_idleWindows = 0;
+        m_frequency = 0;
+    }
+
+    void edge(uint64_t t_ns)
+    {
+        if (m_windowCount == 0) { m_first_ns = t_ns; }
+
+        ++m_count;
+        ++m_windowCount;
+        m_last_ns = t_ns;
+    }
+
+    /**
+     * @brief Closes the window and computes the frequency.
+     *
+     * @param edgesPerPeriod Counted edges per signal period (1 or 2)
+     */
+    void window(uint64_t now_ns, unsigned edgesPerPeriod, Snapshot& snapshot)
+    {
+        if (m_windowCount > 0)
+        {
+            // the first window has no reference, the time between its first and last edge is used
+            uint64_t n = m_windowCount;
+            uint64_t ref = m_ref_ns;
+
+            if (!m_refValid)
+            {
+                n = m_windowCount - 1;
+                ref = m_first_ns;
+            }
+
+            if ((n > 0) && (m_last_ns > ref)) { m_frequency = (double)n * 1e9 / (double)(m_last_ns - ref) / (double)edgesPerPeriod; }
+
+            m_ref_ns = m_last_ns;
+            m_refValid = true;
+            m_idleWindows = 0;
+        }
+        else if (++m_idleWindows >= 2) { m_frequency = 0; }
+
+        m_windowCount = 0;
+
+        snapshot.count = m_count;
+        snapshot.frequency_Hz = m_frequency;
+        snapshot.period_us = (m_frequency > 0 ? 1e6 / m_frequency : 0);
+        snapshot.t_ns = now_ns;
+    }
+
+private:
+    uint64_t m_count;
+    uint64_t m_windowCount;
+    uint64_t m_first_ns;
+    uint64_t m_last_ns;
+    uint64_t m_ref_ns; // last edge of the previous window with edges
+    bool m_refValid;
+    uint32_t m_idleWindows;
+    double m_frequency;
+
+private:
+    Counter(const Counter& other) = delete;
+    Counter(const Counter&& other) = delete;
+    Counter& operator=(const Counter& other);
+};
+
+/**
+ * @brief Edge event of the GPIO character device, same layout as `struct gpio_v2_line_event`.
+ *
+ * Defined here so that the decoding can be used without the kernel headers (emulator, benchmark).
+ */
+struct LineEvent
+{
+    uint64_t timestamp_ns;
+    uint32_t id;
+    uint32_t offset;
+    uint32_t seqno;
+    uint32_t line_seqno;
+    uint32_t padding[6];
+};
+
+/**
+ * @brief Counts a batch of edge events, as done by the counter thread.
+ *
+ * @param counters Indexed by the pin, 64 elements
+ * @param lastSeqno Line sequence number of the last event per pin, 64 elements, initially 0
+ * @param lost Incremented by the number of lost events per pin (gaps of the line sequence number), 64 elements
+ */
+void decode(const LineEvent* events, size_t count, Counter* counters, uint32_t* lastSeqno, uint32_t* lost);
+
+/**
+ * @brief Starts counting the edges of the pins on a separate thread.
+ *
+ * On the Pi the edges are read from the GPIO character device, the counting rate is limited by the kernel (interrupt
+ * and event buffer), not by the main loop. The lines of the pins must not be requested by other modules (see
+ * `gpio::startPulseCounting()`). In the emulator, or if the character device is not available, the pins are sampled
+ * every `samplePeriod_us` instead, which limits the countable rate to 2kHz.
+ *
+ * @return 0 on success
+ */
+int start(const Config& cfg);
+
+void stop();
+
+bool running();
+
+/**
+ * @brief Returns the latest measurement of a pin, can be called from any thread.
+ *
+ * @return `false` if the pin is not counted or the first window has not yet elapsed
+ */
+bool get(int pin, Snapshot& snapshot);
+
+} // namespace pulse
+
+
+#endif // IG_MIDDLEWARE_PULSE_H
@@ -0,0 +1,315 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "middleware/histogram.h"
+#include "middleware/perf.h"
+#include "middleware/seqlock.h"
+#include "middleware/util.h"
+#include "pwm.h"
+
+#include <rpihal/gpio.h>
+
+
+#define LOG_MODULE_LEVEL LOG_LEVEL_INF
+#define LOG_MODULE_NAME  PWM
+#include "middleware/log.h"
+
+
+namespace {
+
+struct Channel
+{
+    int pin;
+    uint32_t level;      // constant level, or the max level if breathing
+    uint32_t breathe_ms; // 0 for a constant level
+};
+
+struct Settings
+{
+    Channel channels[pwm::maxChannels];
+    size_t count;
+};
+
+// pins which are cleared at the same slot
+struct Entry
+{
+    uint32_t slot;
+    uint64_t clr;
+};
+
+}
+
+
+
+static std::thread thread;
+static std::atomic<bool> run(false);
+static pwm::Config config = pwm::defaultConfig();
+
+// the setters write under the mutex, the thread reads lock-free
+static std::mutex settingsMtx;
+static Settings settings;
+static util::Seqlock<Settings> settingsSeqlock;
+
+static util::Seqlock<pwm::Stats> statsSeqlock;
+
+// switching latency, only written by the thread and merged into `perf` after it has been joined
+static util::Histogram latency;
+
+static void pwmThread();
+static uint32_t channelLevel(const Channel& ch, uint64_t t_ms);
+static void modifyChannel(int pin, uint32_t level, uint32_t breathe_ms);
+
+
+
+int pwm::start(const Config& cfg)
+{
+    if (run) { return 0; }
+
+    size_t count = 0;
+    for (int pin = 0; pin < 64; ++pin)
+    {
+        if (cfg.pins & RPIHAL_GPIO_BIT(pin)) { ++count; }
+    }
+
+    if ((count == 0) || (count > maxChannels) || (cfg.frequency_Hz == 0) || (cfg.resolution < 2) ||
+        (((uint64_t)cfg.frequency_Hz * cfg.resolution) > 1000000))
+    {
+        LOG_ERR("invalid config");
+        return -(__LINE__);
+    }
+
+    config = cfg;
+
+    {
+        std::lock_guard<std::mutex> lock(settingsMtx);
+
+        std::memset(&settings, 0, sizeof(settings));
+
+        for (int pin = 0; pin < 64; ++pin)
+        {
+            if (cfg.pins & RPIHAL_GPIO_BIT(pin))
+            {
+                settings.channels[settings.count].pin = pin;
+                ++settings.count;
+            }
+        }
+
+        settingsSeqlock.write(settings);
+    }
+
+    statsSeqlock.write(Stats());
+
+    run = true;
+    thread = std::thread(pwmThread);
+
+    int err = util::setThreadPriority(thread, cfg.priority);
+    if (err) { LOG_WRN("failed to set SCHED_FIFO priority %i, err: %i %s", cfg.priority, err, std::strerror(err)); }
+
+    if (cfg.cpu >= 0)
+    {
+        err = util::setThreadAffinity(thread, cfg.cpu);
+        if (err) { LOG_WRN("failed to set CPU affinity to %i, err: %i %s", cfg.cpu, err, std::strerror(err)); }
+    }
+
+    LOG_INF("%uHz, %u levels, slot %.1fus", cfg.frequency_Hz, cfg.resolution, 1e6 / ((double)cfg.frequency_Hz * (double)cfg.resolution));
+
+    return 0;
+}
+
+void pwm::stop()
+{
+    if (!run) { return; }
+
+    run = false;
+    if (thread.joinable()) { thread.join(); }
+
+    RPIHAL_GPIO_clr(config.pins);
+
+    perf::merge(perf::P_pwmLatency, latency);
+
+    const Stats s = stats();
+    LOG_INF("%llu periods, %llu late, duty error %.2f%% (max %.2f%%), CPU load %.2f%%", (unsigned long long)s.periods, (unsigned long long)s.late,
+            s.dutyError, s.maxDutyError, s.cpuLoad);
+}
+
+bool pwm::running() { return run; }
+
+uint32_t pwm::resolution() { return config.resolution; }
+
+void pwm::setLevel(int pin, uint32_t level) { modifyChannel(pin, level, 0); }
+
+void pwm::setBreathing(int pin, uint32_t period_ms, uint32_t maxLevel) { modifyChannel(pin, maxLevel, period_ms); }
+
+pwm::Stats pwm::stats()
+{
+    Stats s;
+    statsSeqlock.read(s);
+    return s;
+}
+
+
+
+void pwmThread()
+{
+    const uint32_t resolution = config.resolution;
+    const uint64_t period_ns = 1000000000ull / config.frequency_Hz;
+    const uint64_t slot_ns = period_ns / resolution;
+
+    Settings local;
+
+    Entry entries[pwm::maxChannels];
+
+    pwm::Stats stats;
+    std::memset(&stats, 0, sizeof(stats));
+
+    latency.reset();
+
+    // statistics of the current second
+    double errorSum = 0;
+    double errorMax = 0;
+    uint64_t errorCnt = 0;
+
+    const uint64_t t0_ns = util::monotonic_ns();
+    uint64_t periodStart = t0_ns;
+    uint64_t tStats = t0_ns;
+    uint64_t cpuStats = util::threadCpuTime_ns();
+
+    while (run)
+    {
+        settingsSeqlock.read(local);
+
+        // build the schedule of this period
+        const uint64_t t_ms = (periodStart - t0_ns) / 1000000;
+        uint64_t setMask = 0;
+        uint64_t clrMask = 0;
+        size_t nEntries = 0;
+
+        for (size_t i = 0; i < local.count; ++i)
+        {
+            const Channel& ch = local.channels[i];
+            const uint64_t bit = RPIHAL_GPIO_BIT(ch.pin);
+            const uint32_t level = channelLevel(ch, t_ms);
+
+            if (level == 0) { clrMask |= bit; }
+            else
+            {
+                setMask |= bit;
+
+                if (level < resolution)
+                {
+                    // insertion sort by slot, pins with the same level share the entry
+                    size_t k = 0;
+                    while ((k < nEntries) && (entries[k].slot < level)) { ++k; }
+
+                    if ((k < nEntries) && (entries[k].slot == level)) { entries[k].clr |= bit; }
+                    else
+                    {
+                        for (size_t j = nEntries; j > k; --j) { entries[j] = entries[j - 1]; }
+                        entries[k].slot = level;
+                        entries[k].clr = bit;
+                        ++nEntries;
+                    }
+                }
+            }
+        }
+
+        // execute the schedule
+        util::sleep_until(periodStart);
+
+        if (setMask) { RPIHAL_GPIO_set(setMask); }
+        if (clrMask) { RPIHAL_GPIO_clr(clrMask); }
+        const uint64_t tSet = util::monotonic_ns();
+
+        bool late = ((tSet - periodStart) > slot_ns);
+        latency.record(tSet - periodStart);
+
+        for (size_t k = 0; k < nEntries; ++k)
+        {
+            const uint64_t target = periodStart + entries[k].slot * slot_ns;
+
+            util::sleep_until(target);
+            RPIHAL_GPIO_clr(entries[k].clr);
+            const uint64_t tClr = util::monotonic_ns();
+
+            latency.record(tClr - target);
+            if ((tClr - target) > slot_ns) { late = true; }
+
+            // measured on time vs the ideal on time, relative to the period
+            const double onTime = (double)(tClr - tSet);
+            const double ideal = (double)(entries[k].slot * slot_ns);
+            const double error = (onTime > ideal ? onTime - ideal : ideal - onTime) * 100.0 / (double)period_ns;
+
+            errorSum += error;
+            ++errorCnt;
+            if (error > errorMax) { errorMax = error; }
+        }
+
+        ++stats.periods;
+        if (late) { ++stats.late; }
+
+        periodStart += period_ns;
+
+        // skip the missed periods instead of running them back to back
+        const uint64_t now = util::monotonic_ns();
+        if (now > periodStart) { periodStart += ((now - periodStart) / period_ns + 1) * period_ns; }
+
+        if ((now - tStats) >= 1000000000ull)
+        {
+            const uint64_t cpu = util::threadCpuTime_ns();
+
+            stats.dutyError = (errorCnt > 0 ? errorSum / (double)errorCnt : 0);
+            stats.maxDutyError = errorMax;
+            stats.cpuLoad = (double)(cpu - cpuStats) * 100.0 / (double)(now - tStats);
+            statsSeqlock.write(stats);
+
+            errorSum = 0;
+            errorMax = 0;
+            errorCnt = 0;
+            tStats = now;
+            cpuStats = cpu;
+        }
+    }
+}
+
+uint32_t channelLevel(const Channel& ch, uint64_t t_ms)
+{
+    if (ch.breathe_ms == 0) { return ch.level; }
+
+    // triangle [0, 1], squared for a roughly linear perceived brightness
+    const uint32_t phase = (uint32_t)(t_ms % ch.breathe_ms);
+    const uint32_t half = ch.breathe_ms / 2;
+    const double x = (phase < half ? (double)phase / (double)half : (double)(ch.breathe_ms - phase) / (double)(ch.breathe_ms - half));
+
+    return (uint32_t)(x * x * (double)ch.level + 0.5);
+}
+
+void modifyChannel(int pin, uint32_t level, uint32_t breathe_ms)
+{
+    if (level > config.resolution) { level = config.resolution; }
+
+    std::lock_guard<std::mutex> lock(settingsMtx);
+
+    for (size_t i = 0; i < settings.count; ++i)
+    {
+        Channel& ch = settings.channels[i];
+
+        if (ch.pin == pin)
+        {
+            ch.level = level;
+            ch.breathe_ms = breathe_ms;
+            settingsSeqlock.write(settings);
+            return;
+        }
+    }
+
+    LOG_WRN("GPIO%i is not a PWM pin", pin);
+}
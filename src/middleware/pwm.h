@@ -0,0 +1,95 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_PWM_H
+#define IG_MIDDLEWARE_PWM_H
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace pwm {
+
+constexpr size_t maxChannels = 8;
+
+struct Config
+{
+    uint64_t pins;         // bit mask of the PWM pins (`RPIHAL_GPIO_BIT()`), max `pwm::maxChannels`
+    uint32_t frequency_Hz; // PWM frequency
+    uint32_t resolution;   // number of levels per period, the switching times are multiples of 1 / (frequency * resolution)
+    int priority;          // SCHED_FIFO priority [1, 99]
+    int cpu;               // CPU to pin the thread to, -1 for no affinity
+};
+
+struct Stats
+{
+    uint64_t periods;     // number of PWM periods since start
+    uint64_t late;        // periods in which a switching time was missed by more than one slot
+    double dutyError;     // mean absolute error of the measured duty cycle [%]
+    double maxDutyError;  // [%]
+    double cpuLoad;       // CPU time of the PWM thread relative to the wall time [%]
+};
+
+static inline Config defaultConfig()
+{
+    Config cfg;
+    cfg.pins = 0;
+    cfg.frequency_Hz = 200;
+    cfg.resolution = 32;
+    cfg.priority = 40;
+    cfg.cpu = -1;
+    return cfg;
+}
+
+/**
+ * @brief Starts the PWM thread.
+ *
+ * At the start of each period the thread builds a schedule of the switching times, all pins with a level > 0 are set
+ * at the start of the period and each pin is cleared at its level. Pins with the same level share one entry, so the
+ * thread wakes up at most once per distinct level and writes the pins with one `RPIHAL_GPIO_set()` and one
+ * `RPIHAL_GPIO_clr()` call per entry. The CPU load rises with the frequency and the number of distinct levels, not
+ * with the resolution. But a higher resolution requires a shorter slot, which leads to a larger duty cycle error
+ * caused by the wakeup latency.
+ *
+ * The pins have to be initialised as outputs and must not be written by anyone else while the PWM is running.
+ *
+ * @return 0 on success
+ */
+int start(const Config& cfg);
+
+void stop();
+
+bool running();
+
+uint32_t resolution();
+
+/**
+ * @brief Sets a constant level, can be called from any thread. Takes effect with the next period.
+ *
+ * @param pin A pin of `Config::pins`
+ * @param level [0, `pwm::resolution()`]
+ */
+void setLevel(int pin, uint32_t level);
+
+/**
+ * @brief Lets the level of the pin breathe from 0 to `maxLevel` and back.
+ *
+ * The brightness follows a squared triangle, which appears roughly linear to the eye.
+ *
+ * @param pin A pin of `Config::pins`
+ * @param period_ms Duration of one breath
+ * @param maxLevel [0, `pwm::resolution()`]
+ */
+void setBreathing(int pin, uint32_t period_ms, uint32_t maxLevel);
+
+/**
+ * @brief Returns the statistics of the PWM thread, updated once per second.
+ */
+Stats stats();
+
+} // namespace pwm
+
+
+#endif // IG_MIDDLEWARE_PWM_H
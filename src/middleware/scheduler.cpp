@@ -0,0 +1,163 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+#include "event-loop.h"
+#include "scheduler.h"
+
+
+#define LOG_MODULE_LEVEL LOG_LEVEL_INF
+#define LOG_MODULE_NAME  SCHED
+#include "middleware/log.h"
+
+
+using timepoint_t = sched::Scheduler::timepoint_t;
+
+
+
+sched::Scheduler::Scheduler()
+    : m_tasks(), m_pos(), m_heap(), m_nTasks(0), m_heapSize(0)
+{}
+
+int sched::Scheduler::add(func_t func, timepoint_t period_us)
+{
+    if (m_nTasks >= capacity)
+    {
+        LOG_ERR("too many tasks");
+        return -(__LINE__);
+    }
+
+    if (!func || (period_us < 0))
+    {
+        LOG_ERR("invalid argument");
+        return -(__LINE__);
+    }
+
+    const int id = (int)m_nTasks;
+    ++m_nTasks;
+
+    m_tasks[id].func = func;
+    m_tasks[id].period = period_us;
+    m_tasks[id].deadline = eventLoop::noDeadline;
+    m_pos[id] = -1;
+
+    return id;
+}
+
+void sched::Scheduler::start(int id, timepoint_t tp)
+{
+    if (!m_valid(id)) { return; }
+
+    if (m_pos[id] >= 0) { m_remove(id); }
+
+    m_tasks[id].deadline = tp;
+    m_push(id);
+}
+
+void sched::Scheduler::stop(int id)
+{
+    if (active(id)) { m_remove(id); }
+}
+
+void sched::Scheduler::run(timepoint_t tpNow)
+{
+    while ((m_heapSize > 0) && (m_tasks[m_heap[0]].deadline <= tpNow))
+    {
+        const int id = m_heap[0];
+        Task& task = m_tasks[id];
+
+        m_remove(id);
+
+        // reschedule before running, so the task can stop or restart itself
+        if (task.period > 0)
+        {
+            task.deadline += task.period;
+            if (task.deadline <= tpNow) { task.deadline = tpNow + task.period; }
+
+            m_push(id);
+        }
+
+        task.func(tpNow);
+    }
+}
+
+timepoint_t sched::Scheduler::deadline() const
+{
+    if (m_heapSize == 0) { return eventLoop::noDeadline; }
+    return m_tasks[m_heap[0]].deadline;
+}
+
+void sched::Scheduler::m_swap(int a, int b)
+{
+    const int tmp = m_heap[a];
+    m_heap[a] = m_heap[b];
+    m_heap[b] = tmp;
+
+    m_pos[m_heap[a]] = a;
+    m_pos[m_heap[b]] = b;
+}
+
+void sched::Scheduler::m_siftUp(int i)
+{
+    while (i > 0)
+    {
+        const int parent = (i - 1) / 2;
+        if (!m_less(i, parent)) { break; }
+
+        m_swap(i, parent);
+        i = parent;
+    }
+}
+
+void sched::Scheduler::m_siftDown(int i)
+{
+    const int n = (int)m_heapSize;
+
+    while (true)
+    {
+        const int l = 2 * i + 1;
+        const int r = l + 1;
+        int smallest = i;
+
+        if ((l < n) && m_less(l, smallest)) { smallest = l; }
+        if ((r < n) && m_less(r, smallest)) { smallest = r; }
+        if (smallest == i) { break; }
+
+        m_swap(i, smallest);
+        i = smallest;
+    }
+}
+
+void sched::Scheduler::m_push(int id)
+{
+    const int i = (int)m_heapSize;
+    ++m_heapSize;
+
+    m_heap[i] = id;
+    m_pos[id] = i;
+
+    m_siftUp(i);
+}
+
+void sched::Scheduler::m_remove(int id)
+{
+    const int i = m_pos[id];
+    const int last = (int)m_heapSize - 1;
+
+    if (i != last)
+    {
+        m_swap(i, last);
+        --m_heapSize;
+
+        const int moved = m_heap[i];
+        m_siftUp(i);
+        m_siftDown(m_pos[moved]);
+    }
+    else { --m_heapSize; }
+
+    m_pos[id] = -1;
+}
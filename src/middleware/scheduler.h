@@ -0,0 +1,98 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_SCHEDULER_H
+#define IG_MIDDLEWARE_SCHEDULER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <omw/clock.h>
+
+
+namespace sched {
+
+/**
+ * @brief Cooperative multi-rate scheduler.
+ *
+ * The deadlines of the active tasks are kept in a binary min-heap, so `run()` only touches the tasks which are due and
+ * `deadline()` is O(1). All functions have to be called from the same thread.
+ */
+class Scheduler
+{
+public:
+    using timepoint_t = omw::clock::timepoint_t;
+    using func_t = void (*)(const timepoint_t& tpNow);
+
+    static constexpr size_t capacity = 16;
+
+public:
+    Scheduler();
+
+    virtual ~Scheduler() {}
+
+    /**
+     * @brief Registers a task, the task is not started.
+     *
+     * @param func Task function
+     * @param period_us Period in us, 0 for a one-shot task
+     * @return Task ID on success, negative on error
+     */
+    int add(func_t func, timepoint_t period_us);
+
+    /**
+     * @brief (Re)schedules the task to be run at `tp`, periodic tasks continue with their period from there.
+     */
+    void start(int id, timepoint_t tp);
+
+    void stop(int id);
+
+    bool active(int id) const { return (m_valid(id) && (m_pos[id] >= 0)); }
+
+    /**
+     * @brief Runs the due tasks in deadline order.
+     *
+     * Periodic tasks are rescheduled drift free. If a task missed a whole period, it's rescheduled relative to `tpNow`
+     * instead of running several times in a row.
+     */
+    void run(timepoint_t tpNow);
+
+    /**
+     * @return Earliest deadline of all active tasks, `eventLoop::noDeadline` if no task is active
+     */
+    timepoint_t deadline() const;
+
+private:
+    struct Task
+    {
+        func_t func;
+        timepoint_t period;
+        timepoint_t deadline;
+    };
+
+    Task m_tasks[capacity];
+    int m_pos[capacity]; // position in the heap, -1 if not active
+    int m_heap[capacity];
+    size_t m_nTasks;
+    size_t m_heapSize;
+
+    bool m_valid(int id) const { return ((id >= 0) && ((size_t)id < m_nTasks)); }
+    bool m_less(int a, int b) const { return (m_tasks[m_heap[a]].deadline < m_tasks[m_heap[b]].deadline); }
+    void m_swap(int a, int b);
+    void m_siftUp(int i);
+    void m_siftDown(int i);
+    void m_push(int id);
+    void m_remove(int id);
+
+private:
+    Scheduler(const Scheduler& other) = delete;
+    Scheduler(const Scheduler&& other) = delete;
+    Scheduler& operator=(const Scheduler& other);
+};
+
+} // namespace sched
+
+
+#endif // IG_MIDDLEWARE_SCHEDULER_H
@@ -0,0 +1,94 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_SEQLOCK_H
+#define IG_MIDDLEWARE_SEQLOCK_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+
+namespace util {
+
+/**
+ * @brief Single writer sequence lock for publishing a latest-value snapshot.
+ *
+ * The writer never waits. Readers never block the writer, they retry if the snapshot was updated while it was copied.
+ * The payload is stored in relaxed atomic words, so a torn copy is detected by the sequence number and is not a data
+ * race.
+ *
+ * @tparam T Trivially copyable payload type
+ */
+template <class T> class Seqlock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "T has to be trivially copyable");
+
+public:
+    Seqlock()
+        : m_seq(0), m_data()
+    {}
+
+    virtual ~Seqlock() {}
+
+    /**
+     * @brief Publishes a new value, must only be called by one thread.
+     */
+    void write(const T& value)
+    {
+        uint64_t buffer[nWords] = {};
+        std::memcpy(buffer, &value, sizeof(T));
+
+        const uint32_t seq = m_seq.load(std::memory_order_relaxed);
+        m_seq.store(seq + 1, std::memory_order_relaxed); // odd, write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < nWords; ++i) { m_data[i].store(buffer[i], std::memory_order_relaxed); }
+
+        m_seq.store(seq + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Reads the latest value, can be called from any thread.
+     *
+     * @return Sequence number of the value, 0 if nothing has been written yet
+     */
+    uint32_t read(T& value) const
+    {
+        uint64_t buffer[nWords];
+        uint32_t seq0, seq1;
+
+        do {
+            seq0 = m_seq.load(std::memory_order_acquire);
+
+            for (size_t i = 0; i < nWords; ++i) { buffer[i] = m_data[i].load(std::memory_order_relaxed); }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            seq1 = m_seq.load(std::memory_order_relaxed);
+        }
+        while ((seq0 & 1) || (seq0 != seq1));
+
+        std::memcpy(&value, buffer, sizeof(T));
+
+        return seq0 / 2;
+    }
+
+private:
+    static constexpr size_t nWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint32_t> m_seq;
+    std::atomic<uint64_t> m_data[nWords];
+
+    Seqlock(const Seqlock& other) = delete;
+    Seqlock(const Seqlock&& other) = delete;
+    Seqlock& operator=(const Seqlock& other);
+};
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_SEQLOCK_H
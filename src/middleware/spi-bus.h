@@ -0,0 +1,46 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_SPIBUS_H
+#define IG_MIDDLEWARE_SPIBUS_H
+
+#include <cstdint>
+#include <mutex>
+
+#include <rpihal/spi.h>
+
+
+namespace spiBus {
+
+/**
+ * @brief Lock of `/dev/spidev0.0`.
+ *
+ * The ADC and the LED bar share the bus. The LED bar drives its latch as GPIO, so a transfer including the latch
+ * toggling has to be done while holding this lock. The ADC transfers have to hold it too.
+ */
+inline std::mutex& spi0() // not static, has to be one instance across all translation units
+{
+    static std::mutex mtx;
+    return mtx;
+}
+
+/**
+ * @brief Configuration flags of `/dev/spidev0.0`.
+ *
+ * CE0 (GPIO 8) is the nCS of the ADC. Depending on the chip select strategy of the ADC (`adc::CS`) it is toggled by
+ * the kernel, or driven as GPIO with `RPIHAL_SPI_CFG_NO_CS` set. If the kernel toggles it, the LED bar transfers
+ * toggle it too, the ADC ignores them as its output is not read. The mode is a property of the device, not of the file
+ * descriptor, so all users of the bus have to open it with the same flags. They are set by `adc::init()`.
+ */
+inline uint32_t& spi0Flags() // not static, has to be one instance across all translation units
+{
+    static uint32_t flags = RPIHAL_SPI_CFG_MODE_0;
+    return flags;
+}
+
+} // namespace spiBus
+
+
+#endif // IG_MIDDLEWARE_SPIBUS_H
@@ -0,0 +1,83 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_SPSCQUEUE_H
+#define IG_MIDDLEWARE_SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace util {
+
+/**
+ * @brief Lock-free single-producer/single-consumer queue with fixed capacity.
+ *
+ * `push()` must only be called by one thread and `pop()` by one (other) thread. Neither of them blocks or allocates.
+ *
+ * @tparam T Trivially copyable element type
+ * @tparam N Capacity, has to be a power of two
+ */
+template <class T, size_t N> class SpscQueue
+{
+    static_assert((N >= 2) && ((N & (N - 1)) == 0), "N has to be a power of two");
+
+public:
+    SpscQueue()
+        : m_head(0), m_tail(0), m_buffer()
+    {}
+
+    virtual ~SpscQueue() {}
+
+    /**
+     * @return `false` if the queue is full
+     */
+    bool push(const T& item)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+
+        if ((head - m_tail.load(std::memory_order_acquire)) >= N) { return false; }
+
+        m_buffer[head & (N - 1)] = item;
+        m_head.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * @return `false` if the queue is empty
+     */
+    bool pop(T& item)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+
+        if (tail == m_head.load(std::memory_order_acquire)) { return false; }
+
+        item = m_buffer[tail & (N - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    bool empty() const { return (m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire)); }
+
+    static constexpr size_t capacity() { return N; }
+
+private:
+    // separate cache lines, so producer and consumer don't invalidate each others index
+    alignas(64) std::atomic<size_t> m_head;
+    alignas(64) std::atomic<size_t> m_tail;
+    alignas(64) T m_buffer[N];
+
+    SpscQueue(const SpscQueue& other) = delete;
+    SpscQueue(const SpscQueue&& other) = delete;
+    SpscQueue& operator=(const SpscQueue& other);
+};
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_SPSCQUEUE_H
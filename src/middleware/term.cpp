@@ -0,0 +1,288 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <cerrno>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#include "event-loop.h"
+#include "term.h"
+
+#include <omw/defs.h>
+
+#ifndef OMW_PLAT_WIN
+#include <unistd.h>
+#endif
+
+
+// no logging in this module, the log output is written by this module
+
+
+using omw::clock::timepoint_t;
+
+
+namespace {
+
+struct Cell
+{
+    char ch[4];      // UTF-8 encoded code point
+    uint8_t len;     // number of bytes in `ch`
+    const char* sgr; // SGR escape sequence, `nullptr` for the default colors
+};
+
+}
+
+static const char* const sgrReset = "\033[39;49m";
+
+static std::mutex mtx;
+static bool enabled = false;
+static bool dirty = false;
+static bool frontValid = false; // `false` if the status line on the terminal is unknown (erased by a log line)
+static timepoint_t minPeriod_us = 0;
+static timepoint_t tpLastFrame = 0;
+static Cell back[term::width];
+static Cell front[term::width];
+
+static char frameBuffer[term::width * 32 + 64];
+static constexpr size_t frameReserve = 32; // for the reset sequence at the end of the frame
+
+static void clearCell(Cell& cell);
+static bool cellEqual(const Cell& a, const Cell& b);
+static void render();
+static void writeOut(const char* data, size_t count);
+
+
+
+int term::init(uint32_t maxFps)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    for (int i = 0; i < width; ++i) { clearCell(back[i]); }
+
+    if (maxFps == 0) { minPeriod_us = 0; }
+    else { minPeriod_us = omw::clock::second_us / maxFps; }
+
+    tpLastFrame = 0;
+    frontValid = false;
+    dirty = true;
+    enabled = true;
+
+    return 0;
+}
+
+void term::deinit()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    if (enabled && dirty) { render(); }
+
+    enabled = false;
+}
+
+void term::task()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    if (enabled && dirty && (omw::clock::now() >= (tpLastFrame + minPeriod_us))) { render(); }
+}
+
+timepoint_t term::deadline()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    if (!enabled || !dirty) { return eventLoop::noDeadline; }
+
+    return tpLastFrame + minPeriod_us;
+}
+
+void term::invalidate()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    frontValid = false;
+    dirty = true;
+}
+
+void term::put(int col, const char* str, const char* sgr)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    if (!enabled) { return; }
+
+    while ((col >= 0) && (col < width) && (*str != 0))
+    {
+        const uint8_t lead = (uint8_t)(*str);
+        size_t len;
+
+        if ((lead & 0x80) == 0x00) { len = 1; }
+        else if ((lead & 0xE0) == 0xC0) { len = 2; }
+        else if ((lead & 0xF0) == 0xE0) { len = 3; }
+        else if ((lead & 0xF8) == 0xF0) { len = 4; }
+        else { len = 1; } // invalid lead byte
+
+        Cell cell;
+        cell.len = 0;
+        cell.sgr = sgr;
+        while ((cell.len < len) && (*str != 0)) { cell.ch[cell.len++] = *(str++); }
+
+        if (!cellEqual(cell, back[col]))
+        {
+            back[col] = cell;
+            dirty = true;
+        }
+
+        ++col;
+    }
+}
+
+void term::putf(int col, int fieldWidth, const char* format, ...)
+{
+    char buffer[width * 4 + 1];
+
+    std::va_list args;
+    va_start(args, format);
+    const int n = std::vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    if (n < 0) { return; }
+
+    // the remaining cells of the field are filled with spaces, one code point is one cell (as in `term::put()`)
+    size_t len = 0;
+    int cells = 0;
+    for (; buffer[len] != 0; ++len)
+    {
+        if ((((uint8_t)buffer[len]) & 0xC0) != 0x80) { ++cells; } // skip continuation bytes
+    }
+
+    while ((cells < fieldWidth) && (len < (sizeof(buffer) - 1)))
+    {
+        buffer[len++] = ' ';
+        ++cells;
+    }
+    buffer[len] = 0;
+
+    term::put(col, buffer);
+}
+
+void term::writeLog(const char* data, size_t count)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    writeOut(data, count);
+
+    if (enabled)
+    {
+        frontValid = false;
+        dirty = true;
+    }
+}
+
+
+
+void clearCell(Cell& cell)
+{
+    cell.ch[0] = ' ';
+    cell.len = 1;
+    cell.sgr = nullptr;
+}
+
+bool cellEqual(const Cell& a, const Cell& b)
+{
+    if ((a.len != b.len) || (std::memcmp(a.ch, b.ch, a.len) != 0)) { return false; }
+
+    if (a.sgr == b.sgr) { return true; }
+    if ((a.sgr == nullptr) || (b.sgr == nullptr)) { return false; }
+    return (std::strcmp(a.sgr, b.sgr) == 0);
+}
+
+// has to be called with the lock held
+void render()
+{
+    char* p = frameBuffer;
+    const char* currentSgr = nullptr;
+    int cursor = -1; // column of the terminal cursor, -1 if it has to be positioned
+    bool complete = true;
+
+    if (!frontValid)
+    {
+        // the line has been erased, all cells are drawn
+        for (int i = 0; i < term::width; ++i)
+        {
+            front[i].len = 0;
+            front[i].sgr = nullptr;
+        }
+    }
+
+    p += std::sprintf(p, "%s", sgrReset);
+
+    for (int i = 0; i < term::width; ++i)
+    {
+        const Cell& cell = back[i];
+
+        if (cellEqual(cell, front[i])) { continue; }
+
+        // cursor move, SGR and the code point
+        const size_t required = 8 + (cell.sgr ? std::strlen(cell.sgr) : std::strlen(sgrReset)) + cell.len + frameReserve;
+        if ((size_t)(frameBuffer + sizeof(frameBuffer) - p) < required)
+        {
+            complete = false; // the remaining cells are drawn with the next frame
+            break;
+        }
+
+        if (cursor != i) { p += std::sprintf(p, "\033[%iG", i + 1); } // CSI CHA, 1 based
+
+        const bool sgrChanged = !((cell.sgr == currentSgr) || (cell.sgr && currentSgr && (std::strcmp(cell.sgr, currentSgr) == 0)));
+        if (sgrChanged)
+        {
+            p += std::sprintf(p, "%s", (cell.sgr ? cell.sgr : sgrReset));
+            currentSgr = cell.sgr;
+        }
+
+        std::memcpy(p, cell.ch, cell.len);
+        p += cell.len;
+
+        cursor = i + 1;
+        front[i] = cell;
+    }
+
+    // the cursor is parked at the beginning of the line, so that log lines start there
+    p += std::sprintf(p, "%s\r", sgrReset);
+
+    writeOut(frameBuffer, (size_t)(p - frameBuffer));
+
+    frontValid = true;
+    dirty = !complete;
+    tpLastFrame = omw::clock::now();
+}
+
+// has to be called with the lock held
+void writeOut(const char* data, size_t count)
+{
+    // output of printf() has to be written before
+    std::fflush(stdout);
+
+#ifndef OMW_PLAT_WIN
+    while (count > 0)
+    {
+        const ssize_t n = ::write(STDOUT_FILENO, data, count);
+
+        if (n < 0)
+        {
+            if (errno == EINTR) { continue; }
+            break;
+        }
+
+        data += n;
+        count -= (size_t)n;
+    }
+#else
+    std::fwrite(data, 1, count, stdout);
+    std::fflush(stdout);
+#endif
+}
@@ -0,0 +1,82 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_TERM_H
+#define IG_MIDDLEWARE_TERM_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <omw/clock.h>
+
+
+namespace term {
+
+// number of cells of the status line, the rest of the line is not touched
+constexpr int width = 48;
+
+/**
+ * @brief Enables the status line renderer.
+ *
+ * @param maxFps Maximum number of frames per second, 0 for unlimited
+ * @return 0 on success
+ */
+int init(uint32_t maxFps);
+
+/**
+ * @brief Renders the last frame and disables the renderer.
+ */
+void deinit();
+
+/**
+ * @brief Writes the changed cells of the status line if the frame period has elapsed.
+ *
+ * Has to be called from the main loop.
+ */
+void task();
+
+/**
+ * @return Time at which `term::task()` renders a pending frame, `eventLoop::noDeadline` if nothing is pending
+ */
+omw::clock::timepoint_t deadline();
+
+/**
+ * @brief Forces a full redraw with the next frame.
+ *
+ * Has to be called after something else has been printed to stdout (the status line has been overwritten).
+ */
+void invalidate();
+
+/**
+ * @brief Writes a UTF-8 string to the back buffer, one code point per cell.
+ *
+ * @param col First cell
+ * @param str String, clipped at the end of the line
+ * @param sgr SGR escape sequence applied to the cells, `nullptr` for the default colors
+ */
+void put(int col, const char* str, const char* sgr = nullptr);
+
+/**
+ * @brief Formats a string and writes it to the back buffer (see `term::put()`).
+ *
+ * @param col First cell
+ * @param fieldWidth The remaining cells of the field are cleared
+ */
+#if defined(__GNUC__)
+__attribute__((format(printf, 3, 4)))
+#endif
+void putf(int col, int fieldWidth, const char* format, ...);
+
+/**
+ * @brief Writes log lines in between frames, thread safe.
+ *
+ * The status line is erased by the log line (CSI EL) and redrawn with the next frame. Can be used before `term::init()`.
+ */
+void writeLog(const char* data, size_t count);
+
+} // namespace term
+
+
+#endif // IG_MIDDLEWARE_TERM_H
@@ -0,0 +1,204 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+
+#include "middleware/seqlock.h"
+#include "middleware/util.h"
+#include "timestamp.h"
+
+#include <omw/defs.h>
+
+
+// no logging in this module, it's used by the log backend
+
+
+static constexpr int64_t second_ns = 1000000000;
+static constexpr int64_t resyncPeriod_ns = 60 * second_ns;
+
+namespace {
+
+struct Anchor
+{
+    int64_t wall_ns;
+    uint64_t mono_ns;
+};
+
+struct Cache
+{
+    int64_t sec = INT64_MIN;
+    size_t len = 0;
+    size_t tzLen = 0;
+    char prefix[48]; // formatted date/time of `sec`
+    char tz[8];      // UTC offset, only used by `TSF_iso8601`
+};
+
+}
+
+static util::Seqlock<Anchor> anchor;
+static std::mutex anchorMtx; // the seqlock allows only one writer
+
+static thread_local Cache cache[util::TSF__end_];
+
+static void resync(Anchor& a, bool wait);
+static bool localTime(int64_t sec, struct std::tm& tm);
+static void updateCache(Cache& c, int format, int64_t sec);
+static size_t append(char* buffer, size_t size, size_t len, const char* str, size_t count);
+
+
+
+int64_t util::monotonic_to_wall_ns(uint64_t t_ns)
+{
+    Anchor a;
+
+    if (anchor.read(a) == 0) { resync(a, true); }
+    else if ((int64_t)(t_ns - a.mono_ns) >= resyncPeriod_ns) { resync(a, false); }
+
+    // the difference is signed, the timepoint can be older than the anchor
+    return a.wall_ns + (int64_t)(t_ns - a.mono_ns);
+}
+
+size_t util::format_timestamp(char* buffer, size_t size, int format, int resolution, int64_t wall_ns)
+{
+    if (size == 0) { return 0; }
+
+    if ((format < 0) || (format >= TSF__end_)) { format = TSF_iso8601_local; }
+
+    int64_t sec = wall_ns / second_ns;
+    int64_t frac_ns = wall_ns % second_ns;
+    if (frac_ns < 0)
+    {
+        --sec;
+        frac_ns += second_ns;
+    }
+
+    Cache& c = cache[format];
+    if (c.sec != sec) { updateCache(c, format, sec); }
+
+    size_t len = append(buffer, size, 0, c.prefix, c.len);
+
+    if (resolution != TSR_s)
+    {
+        char frac[8];
+        size_t nDigits;
+        uint32_t value;
+
+        if (resolution == TSR_us)
+        {
+            nDigits = 6;
+            value = (uint32_t)(frac_ns / 1000);
+        }
+        else
+        {
+            nDigits = 3;
+            value = (uint32_t)(frac_ns / 1000000);
+        }
+
+        frac[0] = '.';
+        for (size_t i = nDigits; i > 0; --i)
+        {
+            frac[i] = (char)('0' + (value % 10));
+            value /= 10;
+        }
+
+        len = append(buffer, size, len, frac, nDigits + 1);
+    }
+
+    len = append(buffer, size, len, c.tz, c.tzLen);
+
+    buffer[len] = 0;
+
+    return len;
+}
+
+
+
+void resync(Anchor& a, bool wait)
+{
+    std::unique_lock<std::mutex> lock(anchorMtx, std::defer_lock);
+
+    // an other thread is already resyncing, the current anchor is good enough
+    if (wait) { lock.lock(); }
+    else if (!lock.try_lock()) { return; }
+
+    // the monotonic time is taken before and after the wall clock, the middle is used
+    const uint64_t mono0 = util::monotonic_ns();
+    const auto wall = std::chrono::system_clock::now();
+    const uint64_t mono1 = util::monotonic_ns();
+
+    a.wall_ns = (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(wall.time_since_epoch()).count();
+    a.mono_ns = mono0 + (mono1 - mono0) / 2;
+
+    anchor.write(a);
+}
+
+bool localTime(int64_t sec, struct std::tm& tm)
+{
+    const time_t t = (time_t)sec;
+
+#ifdef OMW_PLAT_WIN
+    return (localtime_s(&tm, &t) == 0);
+#else
+    return (localtime_r(&t, &tm) != nullptr);
+#endif
+}
+
+void updateCache(Cache& c, int format, int64_t sec)
+{
+    struct std::tm tm;
+    size_t len = 0;
+
+    c.tzLen = 0;
+
+    if (localTime(sec, tm))
+    {
+        const char* fmt;
+
+        switch (format)
+        {
+        case util::TSF_iso8601:
+            fmt = "%FT%T";
+            break;
+
+        case util::TSF_time_local:
+            fmt = "%T";
+            break;
+
+        default:
+            fmt = "%FT%T";
+            break;
+        }
+
+        len = std::strftime(c.prefix, sizeof(c.prefix), fmt, &tm);
+
+        if ((len > 0) && (format == util::TSF_iso8601)) { c.tzLen = std::strftime(c.tz, sizeof(c.tz), "%z", &tm); }
+    }
+
+    if (len == 0)
+    {
+        const int n = std::snprintf(c.prefix, sizeof(c.prefix), "[%lli]", (long long)sec);
+        len = (n > 0 ? (size_t)n : 0);
+        if (len >= sizeof(c.prefix)) { len = sizeof(c.prefix) - 1; }
+    }
+
+    c.len = len;
+    c.sec = sec;
+}
+
+// appends as much as fits, one byte is kept for the null terminator
+size_t append(char* buffer, size_t size, size_t len, const char* str, size_t count)
+{
+    if ((len + count) >= size) { count = size - 1 - len; }
+
+    std::memcpy(buffer + len, str, count);
+
+    return len + count;
+}
@@ -0,0 +1,57 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_TIMESTAMP_H
+#define IG_MIDDLEWARE_TIMESTAMP_H
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace util {
+
+enum TS_FORMAT
+{
+    TSF_iso8601 = 0,   // %FT%T%z, the offset is appended after the fraction
+    TSF_iso8601_local, // %FT%T
+    TSF_time_local,    // %T
+
+    TSF__end_
+};
+
+enum TS_RESOLUTION
+{
+    TSR_s = 0,
+    TSR_ms,
+    TSR_us,
+};
+
+/**
+ * @brief Converts a `util::monotonic_ns()` timepoint to wall clock time.
+ *
+ * The offset between the clocks is measured on first use and again every minute, so reading the wall clock is not
+ * needed per call and the fraction of the second is consistent with the monotonic clock.
+ *
+ * @return ns since the epoch
+ */
+int64_t monotonic_to_wall_ns(uint64_t t_ns);
+
+/**
+ * @brief Formats a timestamp into the buffer, allocation free.
+ *
+ * The date/time part is formatted only once per second (per thread and format), the fraction is appended.
+ *
+ * @param buffer Destination, always null terminated if `size > 0`
+ * @param format Format (`util::TS_FORMAT`)
+ * @param resolution Resolution of the fraction (`util::TS_RESOLUTION`)
+ * @param wall_ns Wall clock time, ns since the epoch
+ * @return Number of characters written, excluding the null terminator
+ */
+size_t format_timestamp(char* buffer, size_t size, int format, int resolution, int64_t wall_ns);
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_TIMESTAMP_H
@@ -3,6 +3,7 @@ author          Oliver Blaser
 copyright       MIT - Copyright (c) 2024 Oliver Blaser
 */
 
+#include <cerrno>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
@@ -10,13 +11,19 @@ copyright       MIT - Copyright (c) 2024 Oliver Blaser
 #include <ctime>
 #include <string>
 
+#include "timestamp.h"
 #include "util.h"
 
 #include <omw/defs.h>
 
 #ifdef OMW_PLAT_WIN
+#include <chrono>
+#include <thread>
+
 #include <Windows.h>
 #else // OMW_PLAT_WIN
+#include <pthread.h>
+#include <sched.h>
 #include <time.h>
 #endif // OMW_PLAT_WIN
 
@@ -27,62 +34,133 @@ namespace {}
 
 std::string util::t_to_iso8601(time_t t)
 {
-    std::string r;
+    char buffer[64];
+    const size_t len = util::format_timestamp(buffer, sizeof(buffer), util::TSF_iso8601, util::TSR_s, (int64_t)t * 1000000000);
+    return std::string(buffer, len);
+}
+
+std::string util::t_to_iso8601_local(time_t t)
+{
+    char buffer[64];
+    const size_t len = util::format_timestamp(buffer, sizeof(buffer), util::TSF_iso8601_local, util::TSR_s, (int64_t)t * 1000000000);
+    return std::string(buffer, len);
+}
+
+std::string util::t_to_iso8601_time_local(time_t t)
+{
+    char buffer[64];
+    const size_t len = util::format_timestamp(buffer, sizeof(buffer), util::TSF_time_local, util::TSR_s, (int64_t)t * 1000000000);
+    return std::string(buffer, len);
+}
 
-    constexpr size_t bufferSize = 100;
-    char buffer[bufferSize];
+int util::sleep(uint32_t t_ms)
+{
+#ifdef OMW_PLAT_WIN
 
-    const struct std::tm* tm = std::localtime(&t);
+    Sleep(t_ms);
+    return 0;
 
-    if (tm && (std::strftime(buffer, bufferSize, "%FT%T%z", tm) > 0)) { r = std::string(buffer); }
-    else { r = '[' + std::to_string(t) + ']'; }
+#else // OMW_PLAT_WIN
 
-    return r;
+    struct timespec ts;
+    ts.tv_sec = (time_t)(t_ms / 1000);
+    ts.tv_nsec = (int32_t)((t_ms - ((uint32_t)(ts.tv_sec) * 1000)) * 1000000);
+    return nanosleep(&ts, NULL);
+
+#endif // OMW_PLAT_WIN
 }
 
-std::string util::t_to_iso8601_local(time_t t)
+uint64_t util::monotonic_ns()
 {
-    std::string r;
+#ifdef OMW_PLAT_WIN
 
-    constexpr size_t bufferSize = 100;
-    char buffer[bufferSize];
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
 
-    const struct std::tm* tm = std::localtime(&t);
+#else // OMW_PLAT_WIN
 
-    if (tm && (std::strftime(buffer, bufferSize, "%FT%T", tm) > 0)) { r = std::string(buffer); }
-    else { r = '[' + std::to_string(t) + ']'; }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec);
 
-    return r;
+#endif // OMW_PLAT_WIN
 }
 
-std::string util::t_to_iso8601_time_local(time_t t)
+int util::sleep_until(uint64_t t_ns)
 {
-    std::string r;
+#ifdef OMW_PLAT_WIN
 
-    constexpr size_t bufferSize = 100;
-    char buffer[bufferSize];
+    const uint64_t now = util::monotonic_ns();
+    if (t_ns > now) { std::this_thread::sleep_for(std::chrono::nanoseconds(t_ns - now)); }
+    return 0;
 
-    const struct std::tm* tm = std::localtime(&t);
+#else // OMW_PLAT_WIN
 
-    if (tm && (std::strftime(buffer, bufferSize, "%T", tm) > 0)) { r = std::string(buffer); }
-    else { r = '[' + std::to_string(t) + ']'; }
+    struct timespec ts;
+    ts.tv_sec = (time_t)(t_ns / 1000000000ull);
+    ts.tv_nsec = (long)(t_ns % 1000000000ull);
 
-    return r;
+    int err;
+    do {
+        err = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+    }
+    while (err == EINTR);
+
+    return err;
+
+#endif // OMW_PLAT_WIN
 }
 
-int util::sleep(uint32_t t_ms)
+uint64_t util::threadCpuTime_ns()
 {
 #ifdef OMW_PLAT_WIN
 
-    Sleep(t_ms);
-    return 0;
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) { return 0; }
+
+    // 100ns units
+    const uint64_t k = ((uint64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+    const uint64_t u = ((uint64_t)user.dwHighDateTime << 32) | user.dwLowDateTime;
+    return (k + u) * 100;
 
 #else // OMW_PLAT_WIN
 
     struct timespec ts;
-    ts.tv_sec = (time_t)(t_ms / 1000);
-    ts.tv_nsec = (int32_t)((t_ms - ((uint32_t)(ts.tv_sec) * 1000)) * 1000000);
-    return nanosleep(&ts, NULL);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec);
+
+#endif // OMW_PLAT_WIN
+}
+
+int util::setThreadPriority(std::thread& thread, int priority)
+{
+#ifdef OMW_PLAT_WIN
+
+    return ENOTSUP;
+
+#else // OMW_PLAT_WIN
+
+    struct sched_param param;
+    std::memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+
+    return pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &param);
+
+#endif // OMW_PLAT_WIN
+}
+
+int util::setThreadAffinity(std::thread& thread, int cpu)
+{
+#ifdef OMW_PLAT_WIN
+
+    return ENOTSUP;
+
+#else // OMW_PLAT_WIN
+
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(cpuset), &cpuset);
 
 #endif // OMW_PLAT_WIN
 }
@@ -10,6 +10,7 @@ copyright       MIT - Copyright (c) 2024 Oliver Blaser
 #include <cstdint>
 #include <ctime>
 #include <string>
+#include <thread>
 
 
 
@@ -32,6 +33,40 @@ std::string t_to_iso8601_time_local(time_t t);
 
 int sleep(uint32_t t_ms);
 
+/**
+ * @brief Monotonic clock with ns resolution, not related to the wall clock.
+ */
+uint64_t monotonic_ns();
+
+/**
+ * @brief Sleeps until the absolute point in time is reached.
+ *
+ * Used for drift free periodic threads.
+ *
+ * @param t_ns Absolute time of the `util::monotonic_ns()` clock
+ */
+int sleep_until(uint64_t t_ns);
+
+/**
+ * @brief CPU time consumed by the calling thread, used to measure the load of a thread.
+ */
+uint64_t threadCpuTime_ns();
+
+/**
+ * @brief Sets the real-time policy `SCHED_FIFO` with the priority.
+ *
+ * @param priority [1, 99]
+ * @return 0 on success, the error number otherwise
+ */
+int setThreadPriority(std::thread& thread, int priority);
+
+/**
+ * @brief Pins the thread to a CPU.
+ *
+ * @return 0 on success, the error number otherwise
+ */
+int setThreadAffinity(std::thread& thread, int cpu);
+
 } // namespace util
 
 
@@ -0,0 +1,224 @@
+/*
+author          Oliver Blaser
+copyright       MIT - Copyright (c) 2026 Oliver Blaser
+*/
+
+// Converts a binary log file (`logging::startBinary()`) to text.
+//
+// Usage: rpihal-log-decode FILE [--no-color]
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "middleware/log-format.h"
+
+
+namespace {
+
+struct Site
+{
+    uint32_t line;
+    std::string file;
+    std::string format;
+};
+
+}
+
+static bool readFile(const char* filename, std::vector<uint8_t>& data);
+static size_t formatTimestamp(char* buffer, size_t size, int64_t wall_ns);
+static void stripEscapeSequences(char* str);
+
+
+
+int main(int argc, char** argv)
+{
+    const char* filename = nullptr;
+    bool color = true;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--no-color") == 0) { color = false; }
+        else { filename = argv[i]; }
+    }
+
+    if (!filename)
+    {
+        std::fprintf(stderr, "Usage: %s FILE [--no-color]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<uint8_t> data;
+    if (!readFile(filename, data))
+    {
+        std::fprintf(stderr, "failed to read \"%s\"\n", filename);
+        return 1;
+    }
+
+    logging::BinFileHeader fileHeader;
+    if (data.size() < sizeof(fileHeader))
+    {
+        std::fprintf(stderr, "invalid file\n");
+        return 1;
+    }
+    std::memcpy(&fileHeader, data.data(), sizeof(fileHeader));
+
+    if (std::memcmp(fileHeader.magic, logging::binMagic, sizeof(fileHeader.magic)) != 0)
+    {
+        std::fprintf(stderr, "not a binary log file\n");
+        return 1;
+    }
+    if (fileHeader.byteOrder != logging::binByteOrder)
+    {
+        std::fprintf(stderr, "the file has been written on a host with a different byte order\n");
+        return 1;
+    }
+    if (fileHeader.version != logging::binVersion)
+    {
+        std::fprintf(stderr, "unsupported version %u\n", (unsigned)fileHeader.version);
+        return 1;
+    }
+
+    // two passes, a definition can be written after the first event of its call site (by an other thread)
+    std::unordered_map<uint32_t, Site> sites;
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        size_t offset = logging::binAlign(sizeof(fileHeader));
+
+        while ((offset + sizeof(logging::BinRecordHeader)) <= data.size())
+        {
+            logging::BinRecordHeader header;
+            std::memcpy(&header, data.data() + offset, sizeof(header));
+
+            if (header.type == logging::BRT_end) { break; }
+
+            const uint8_t* const payload = data.data() + offset + sizeof(header);
+            if ((offset + sizeof(header) + header.size) > data.size())
+            {
+                std::fprintf(stderr, "truncated record at offset %zu\n", offset);
+                break;
+            }
+
+            if ((pass == 0) && (header.type == logging::BRT_def))
+            {
+                Site site;
+                std::memcpy(&site.line, payload, sizeof(site.line));
+
+                const char* const file = (const char*)(payload + sizeof(site.line));
+                const size_t fileLen = strnlen(file, header.size - sizeof(site.line));
+                site.file.assign(file, fileLen);
+
+                const char* const format = file + fileLen + 1;
+                const size_t formatMax = header.size - sizeof(site.line) - fileLen - 1;
+                site.format.assign(format, strnlen(format, formatMax));
+
+                const auto it = sites.find(header.id);
+                if ((it != sites.end()) && ((it->second.line != site.line) || (it->second.file != site.file) || (it->second.format != site.format)))
+                {
+                    std::fprintf(stderr, "call site ID collision 0x%08x: %s:%u and %s:%u\n", (unsigned)header.id, it->second.file.c_str(), (unsigned)it->second.line,
+                                 site.file.c_str(), (unsigned)site.line);
+                }
+
+                sites[header.id] = site;
+            }
+            else if ((pass == 1) && (header.type == logging::BRT_event))
+            {
+                char line[1024];
+                size_t len = 0;
+
+                const int64_t wall_ns = fileHeader.anchorWall_ns + (int64_t)(header.t_ns - fileHeader.anchorMono_ns);
+
+                line[len++] = '[';
+                len += formatTimestamp(line + len, sizeof(line) - len, wall_ns);
+                line[len++] = ']';
+                line[len++] = ' ';
+
+                const auto it = sites.find(header.id);
+                if (it != sites.end()) { len += logging::formatMessage(line + len, sizeof(line) - len, it->second.format.c_str(), payload, header.size); }
+                else { len += std::snprintf(line + len, sizeof(line) - len, "<unknown call site 0x%08x>\n", (unsigned)header.id); }
+
+                if (!color) { stripEscapeSequences(line); }
+
+                std::fputs(line, stdout);
+
+                if (header.flags & logging::BRF_truncated) { std::fputs("  (arguments truncated)\n", stdout); }
+            }
+            else if ((header.type != logging::BRT_def) && (header.type != logging::BRT_event))
+            {
+                std::fprintf(stderr, "invalid record type 0x%02x at offset %zu\n", (int)header.type, offset);
+                break;
+            }
+
+            offset += logging::binAlign(sizeof(header) + header.size);
+        }
+    }
+
+    return 0;
+}
+
+
+
+bool readFile(const char* filename, std::vector<uint8_t>& data)
+{
+    std::ifstream ifs(filename, std::ios::in | std::ios::binary);
+    if (!ifs.good()) { return false; }
+
+    data.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+
+    return !ifs.bad();
+}
+
+size_t formatTimestamp(char* buffer, size_t size, int64_t wall_ns)
+{
+    int64_t sec = wall_ns / 1000000000;
+    int64_t frac_ns = wall_ns % 1000000000;
+    if (frac_ns < 0)
+    {
+        --sec;
+        frac_ns += 1000000000;
+    }
+
+    const time_t t = (time_t)sec;
+    struct std::tm tm;
+
+#ifdef _WIN32
+    const bool ok = (localtime_s(&tm, &t) == 0);
+#else
+    const bool ok = (localtime_r(&t, &tm) != nullptr);
+#endif
+
+    size_t len = 0;
+    if (ok) { len = std::strftime(buffer, size, "%FT%T", &tm); }
+
+    const int n = std::snprintf(buffer + len, size - len, ".%06lli", (long long)(frac_ns / 1000));
+    if (n > 0) { len += (size_t)n; }
+
+    return len;
+}
+
+void stripEscapeSequences(char* str)
+{
+    char* dst = str;
+
+    while (*str)
+    {
+        if ((str[0] == '\033') && (str[1] == '['))
+        {
+            // CSI, parameter and intermediate bytes up to the final byte
+            str += 2;
+            while (*str && !((*str >= 0x40) && (*str <= 0x7E))) { ++str; }
+            if (*str) { ++str; }
+        }
+        else { *(dst++) = *(str++); }
+    }
+
+    *dst = 0;
+}